@@ -0,0 +1,64 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: JsonString.h
+// Author: Dennis Lang
+// Desc: Write quoted JSON string literals.
+//
+// Usage:
+//      JsonString(out, name);      // "name" with quotes and escapes
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include <ostream>
+#include <stdio.h>
+
+// ---------------------------------------------------------------------------
+// Quote and escape str as a JSON string. '<' is escaped too so the text
+// is safe inside an html <script> block.
+inline std::ostream& JsonString(std::ostream& out, const char* str)
+{
+    out << '"';
+    for (const char* ptr = str; *ptr != '\0'; ptr++)
+    {
+        unsigned char c = (unsigned char)*ptr;
+        if (c == '"' || c == '\\')
+            out << '\\' << (char)c;
+        else if (c == '<' || c < 0x20)
+        {
+            char hex[8];
+            snprintf(hex, sizeof(hex), "\\u%04x", c);
+            out << hex;
+        }
+        else
+            out << (char)c;
+    }
+    return out << '"';
+}
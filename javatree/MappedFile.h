@@ -0,0 +1,136 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: MappedFile.h
+// Author: Dennis Lang
+// Desc: Map whole file read-only into memory.
+//
+// Usage:
+//      MappedFile map;
+//      if (map.open(path))
+//          Parse(map.data(), map.length());
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include <string>
+#include <fstream>
+#include <iterator>
+
+#ifndef HAVE_WIN
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Read-only file mapping, falls back to reading the file into memory
+// where mmap is not available.
+class MappedFile
+{
+public:
+    MappedFile() :
+        mData(NULL),
+        mLength(0),
+        mMapped(false)
+    { }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    bool open(const lstring& path)
+    {
+        close();
+#ifndef HAVE_WIN
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void* base = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (base != MAP_FAILED)
+            {
+                mData = (const char*)base;
+                mLength = (size_t)info.st_size;
+                mMapped = true;
+            }
+        }
+        ::close(fd);
+        if (mMapped)
+            return true;
+#endif
+        std::ifstream in(path, std::ios::binary);
+        if (!in.good())
+            return false;
+        mBuffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        mData = mBuffer.data();
+        mLength = mBuffer.length();
+        return true;
+    }
+
+    // Use in-memory image instead of a file, image is left empty.
+    void assign(std::string& image)
+    {
+        close();
+        mBuffer.swap(image);
+        mData = mBuffer.data();
+        mLength = mBuffer.length();
+    }
+
+    void close()
+    {
+#ifndef HAVE_WIN
+        if (mMapped)
+            munmap((void*)mData, mLength);
+#endif
+        mBuffer.clear();
+        mData = NULL;
+        mLength = 0;
+        mMapped = false;
+    }
+
+    const char* data() const
+    { return mData; }
+
+    size_t length() const
+    { return mLength; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* mData;
+    size_t      mLength;
+    bool        mMapped;
+    std::string mBuffer;
+};
@@ -0,0 +1,70 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: MemoryStream.h
+// Author: Dennis Lang
+// Desc: Read-only istream over an in-memory buffer (no copy).
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <iostream>
+#include <streambuf>
+
+// ---------------------------------------------------------------------------
+// Wrap an existing buffer as an istream, used to feed git blobs and
+// archive members to the java parser without a temporary file.
+//
+//  MemoryStream in(data, length);
+//  while (reader.getJavaline(in, line).good()) ...
+//
+class MemoryStream : public std::istream
+{
+public:
+    MemoryStream(const char* data, size_t length) :
+        std::istream(&mBuffer),
+        mBuffer(data, length)
+    { }
+
+private:
+    class MemoryBuffer : public std::streambuf
+    {
+    public:
+        MemoryBuffer(const char* data, size_t length)
+        {
+            char* beg = const_cast<char*>(data);
+            setg(beg, beg, beg + length);
+        }
+    };
+
+    MemoryStream(const MemoryStream&);
+    MemoryStream& operator=(const MemoryStream&);
+
+    MemoryBuffer mBuffer;
+};
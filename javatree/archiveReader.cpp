@@ -0,0 +1,425 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: archiveReader.cpp
+// Author: Dennis Lang
+// Desc: Read members of .zip/.jar and .tar/.tar.gz archives without extracting to disk.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "archiveReader.h"
+
+#include <iostream>
+#include <fstream>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <zlib.h>
+
+static const unsigned ZIP_LOCAL_SIG = 0x04034b50;
+static const unsigned ZIP_CENTRAL_SIG = 0x02014b50;
+static const unsigned ZIP_END_SIG = 0x06054b50;
+static const unsigned ZIP64_END_SIG = 0x06064b50;
+static const unsigned ZIP64_LOCATOR_SIG = 0x07064b50;
+static const size_t TAR_BLOCK = 512;
+
+// ---------------------------------------------------------------------------
+// Little endian readers, zip headers are unaligned.
+inline static unsigned Get16(const unsigned char* ptr)
+{
+    return ptr[0] | (ptr[1] << 8);
+}
+
+inline static unsigned Get32(const unsigned char* ptr)
+{
+    return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | ((unsigned)ptr[3] << 24);
+}
+
+inline static unsigned long long Get64(const unsigned char* ptr)
+{
+    return Get32(ptr) | ((unsigned long long)Get32(ptr + 4) << 32);
+}
+
+// ---------------------------------------------------------------------------
+static bool EndsWith(const lstring& str, const char* tail)
+{
+    size_t len = strlen(tail);
+    return str.length() >= len && str.compare(str.length() - len, len, tail) == 0;
+}
+
+// ---------------------------------------------------------------------------
+bool IsZipArchive(const lstring& path)
+{
+    return EndsWith(path, ".zip") || EndsWith(path, ".jar")
+        || EndsWith(path, ".apk") || EndsWith(path, ".aar");
+}
+
+// ---------------------------------------------------------------------------
+bool IsArchive(const lstring& path)
+{
+    return IsZipArchive(path) || EndsWith(path, ".tar")
+        || EndsWith(path, ".tar.gz") || EndsWith(path, ".tgz");
+}
+
+//-------------------------------------------------------------------------------------------------
+ZipReader::ZipReader(const lstring& path) :
+    my_path(path),
+    my_base(NULL),
+    my_length(0)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+ZipReader::~ZipReader()
+{
+    close();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool ZipReader::open()
+{
+    close();
+
+    if (!my_file.open(my_path))
+        return false;
+    my_base = (const unsigned char*)my_file.data();
+    my_length = my_file.length();
+
+    if (my_base == NULL)
+        return false;
+    if (!readCentralDirectory())
+    {
+        std::cerr << "Classtree: Invalid zip archive " << my_path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void ZipReader::close()
+{
+    my_file.close();
+    my_base = NULL;
+    my_length = 0;
+    my_members.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+// Locate end-of-central-directory (and zip64 variant) then read member list.
+bool ZipReader::readCentralDirectory()
+{
+    if (my_length < 22)
+        return false;
+
+    size_t endPos = my_length - 22;
+    size_t stopPos = (my_length > 22 + 0xffff) ? my_length - 22 - 0xffff : 0;
+    while (Get32(my_base + endPos) != ZIP_END_SIG)
+    {
+        if (endPos == stopPos)
+            return false;
+        endPos--;
+    }
+
+    const unsigned char* end = my_base + endPos;
+    unsigned long long count = Get16(end + 10);
+    unsigned long long cdSize = Get32(end + 12);
+    unsigned long long cdOffset = Get32(end + 16);
+
+    if (endPos >= 20 && Get32(end - 20) == ZIP64_LOCATOR_SIG)
+    {
+        unsigned long long end64Pos = Get64(end - 20 + 8);
+        if (end64Pos + 56 <= my_length && Get32(my_base + end64Pos) == ZIP64_END_SIG)
+        {
+            const unsigned char* end64 = my_base + end64Pos;
+            count = Get64(end64 + 32);
+            cdSize = Get64(end64 + 40);
+            cdOffset = Get64(end64 + 48);
+        }
+    }
+
+    if (cdOffset + cdSize > my_length)
+        return false;
+
+    my_members.reserve((size_t)count);
+    const unsigned char* ptr = my_base + cdOffset;
+    const unsigned char* cdEnd = ptr + cdSize;
+    for (unsigned long long idx = 0; idx != count; idx++)
+    {
+        if (ptr + 46 > cdEnd || Get32(ptr) != ZIP_CENTRAL_SIG)
+            return false;
+
+        unsigned flags = Get16(ptr + 8);
+        unsigned nameLen = Get16(ptr + 28);
+        unsigned extraLen = Get16(ptr + 30);
+        unsigned commentLen = Get16(ptr + 32);
+        if (ptr + 46 + nameLen + extraLen + commentLen > cdEnd)
+            return false;
+
+        Member member;
+        member.method = Get16(ptr + 10);
+        member.compSize = Get32(ptr + 20);
+        member.size = Get32(ptr + 24);
+        member.offset = Get32(ptr + 42);
+        member.name.assign((const char*)ptr + 46, nameLen);
+
+        // Zip64 extra field holds the 64bit values flagged as 0xffffffff
+        const unsigned char* extra = ptr + 46 + nameLen;
+        const unsigned char* extraEnd = extra + extraLen;
+        while (extra + 4 <= extraEnd)
+        {
+            unsigned id = Get16(extra);
+            unsigned len = Get16(extra + 2);
+            if (id == 0x0001)
+            {
+                const unsigned char* field = extra + 4;
+                if (member.size == 0xffffffff && field + 8 <= extra + 4 + len)
+                    { member.size = (size_t)Get64(field); field += 8; }
+                if (member.compSize == 0xffffffff && field + 8 <= extra + 4 + len)
+                    { member.compSize = (size_t)Get64(field); field += 8; }
+                if (member.offset == 0xffffffff && field + 8 <= extra + 4 + len)
+                    { member.offset = (size_t)Get64(field); field += 8; }
+            }
+            extra += 4 + len;
+        }
+
+        ptr += 46 + nameLen + extraLen + commentLen;
+
+        bool encrypted = (flags & 1) != 0;
+        bool directory = !member.name.empty() && member.name.back() == '/';
+        if (!encrypted && !directory)
+            my_members.push_back(member);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool ZipReader::read(const Member& member, std::string& data) const
+{
+    data.clear();
+    if (my_base == NULL || member.offset + 30 > my_length)
+        return false;
+
+    const unsigned char* local = my_base + member.offset;
+    if (Get32(local) != ZIP_LOCAL_SIG)
+        return false;
+
+    size_t dataPos = member.offset + 30 + Get16(local + 26) + Get16(local + 28);
+    if (dataPos + member.compSize > my_length)
+        return false;
+    const unsigned char* src = my_base + dataPos;
+
+    if (member.method == 0)
+    {
+        data.assign((const char*)src, member.compSize);
+        return true;
+    }
+    if (member.method != 8)
+        return false;
+
+    data.resize(member.size);
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+        return false;
+
+    zs.next_in = (Bytef*)src;
+    zs.avail_in = (uInt)member.compSize;
+    zs.next_out = (Bytef*)&data[0];
+    zs.avail_out = (uInt)member.size;
+    int status = inflate(&zs, Z_FINISH);
+    inflateEnd(&zs);
+
+    data.resize(zs.total_out);
+    return status == Z_STREAM_END;
+}
+
+//-------------------------------------------------------------------------------------------------
+TarReader::TarReader(const lstring& path) :
+    my_path(path),
+    my_gzFile(NULL),
+    my_remain(0),
+    my_padding(0)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+TarReader::~TarReader()
+{
+    close();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool TarReader::open()
+{
+    close();
+    my_gzFile = gzopen(my_path, "rb");     // plain tar is read as-is
+    if (my_gzFile != NULL)
+        gzbuffer((gzFile)my_gzFile, 256 * 1024);
+    return my_gzFile != NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+void TarReader::close()
+{
+    if (my_gzFile != NULL)
+        gzclose((gzFile)my_gzFile);
+    my_gzFile = NULL;
+    my_remain = my_padding = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool TarReader::readBlock(char* block, size_t length)
+{
+    return gzread((gzFile)my_gzFile, block, (unsigned)length) == (int)length;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool TarReader::skip(size_t length)
+{
+    char block[TAR_BLOCK * 16];
+    while (length != 0)
+    {
+        size_t part = std::min(length, sizeof(block));
+        if (!readBlock(block, part))
+            return false;
+        length -= part;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Tar numbers are octal text, or base-256 when high bit of first byte set.
+static size_t TarNumber(const char* field, size_t length)
+{
+    const unsigned char* ufield = (const unsigned char*)field;
+    size_t value = 0;
+    if (ufield[0] & 0x80)
+    {
+        for (size_t idx = 1; idx < length; idx++)
+            value = (value << 8) | ufield[idx];
+        return value;
+    }
+    for (size_t idx = 0; idx < length && field[idx] != '\0'; idx++)
+    {
+        if (field[idx] >= '0' && field[idx] <= '7')
+            value = value * 8 + (field[idx] - '0');
+    }
+    return value;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool TarReader::next(lstring& name, size_t& size)
+{
+    if (my_gzFile == NULL)
+        return false;
+    if (!skip(my_remain + my_padding))
+        return false;
+    my_remain = my_padding = 0;
+
+    lstring longName;
+    char block[TAR_BLOCK];
+    while (readBlock(block, TAR_BLOCK))
+    {
+        if (block[0] == '\0')
+            return false;   // end-of-archive zero block
+
+        size = TarNumber(block + 124, 12);
+        size_t padding = (TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK;
+        char type = block[156];
+
+        if (type == 'L' || type == 'x')
+        {
+            // GNU long name or pax extended header, applies to next entry.
+            std::string ext;
+            my_remain = size;
+            my_padding = padding;
+            if (!read(ext))
+                return false;
+            if (type == 'L')
+            {
+                longName = ext.c_str();
+            }
+            else
+            {
+                // pax records: "<len> key=value\n"
+                size_t pos = 0;
+                while (pos < ext.length())
+                {
+                    size_t space = ext.find(' ', pos);
+                    size_t recLen = (size_t)strtoul(ext.c_str() + pos, NULL, 10);
+                    if (space == std::string::npos || recLen == 0)
+                        break;
+                    if (ext.compare(space + 1, 5, "path=") == 0)
+                        longName = ext.substr(space + 6, pos + recLen - space - 7);
+                    pos += recLen;
+                }
+            }
+            if (!skip(my_padding))
+                return false;
+            my_padding = 0;
+            continue;
+        }
+
+        my_remain = size;
+        my_padding = padding;
+        if (type != '0' && type != '\0' && type != '7')
+        {
+            // directory, link or global header, nothing to read.
+            if (!skip(my_remain + my_padding))
+                return false;
+            my_remain = my_padding = 0;
+            longName.clear();
+            continue;
+        }
+
+        if (!longName.empty())
+        {
+            name = longName;
+        }
+        else
+        {
+            name.assign(block, strnlen(block, 100));
+            if (memcmp(block + 257, "ustar", 5) == 0 && block[345] != '\0')
+                name = lstring(std::string(block + 345, strnlen(block + 345, 155))) + "/" + name;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool TarReader::read(std::string& data)
+{
+    data.resize(my_remain);
+    bool good = (my_remain == 0) || readBlock(&data[0], my_remain);
+    my_remain = 0;
+    return good;
+}
@@ -0,0 +1,127 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: archiveReader.h
+// Author: Dennis Lang
+// Desc: Read members of .zip/.jar and .tar/.tar.gz archives without extracting to disk.
+//
+// Usage:
+//      ZipReader zip("src.zip");
+//      if (zip.open())
+//          for (size_t idx = 0; idx != zip.members().size(); idx++)
+//              zip.read(zip.members()[idx], data);    // safe from several threads
+//
+//      TarReader tar("src.tar.gz");
+//      if (tar.open())
+//          while (tar.next(name, size))
+//              tar.read(data);
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "MappedFile.h"
+#include <string>
+#include <vector>
+
+// Return true if path names a zip, jar or tar archive.
+bool IsArchive(const lstring& path);
+bool IsZipArchive(const lstring& path);
+
+// ---------------------------------------------------------------------------
+// Random access zip/jar reader, archive is mapped and central directory
+// is read once so members can be inflated in any order.
+class ZipReader
+{
+public:
+    struct Member
+    {
+        lstring  name;
+        size_t   offset;     // local header offset
+        size_t   compSize;
+        size_t   size;
+        unsigned method;     // 0=stored, 8=deflate
+    };
+    typedef std::vector<Member> MemberList;
+
+    ZipReader(const lstring& path);
+    ~ZipReader();
+
+    // Map archive and read central directory.
+    bool open();
+    void close();
+
+    const MemberList& members() const
+    { return my_members; }
+
+    // Inflate member into data, thread safe.
+    bool read(const Member& member, std::string& data) const;
+
+private:
+    ZipReader(const ZipReader&);
+    ZipReader& operator=(const ZipReader&);
+
+    bool readCentralDirectory();
+
+    lstring         my_path;
+    MappedFile      my_file;
+    const unsigned char* my_base;
+    size_t          my_length;
+    MemberList      my_members;
+};
+
+// ---------------------------------------------------------------------------
+// Sequential tar reader, gzip compression is detected and inflated
+// on the fly.
+class TarReader
+{
+public:
+    TarReader(const lstring& path);
+    ~TarReader();
+
+    bool open();
+    void close();
+
+    // Advance to next regular file, return false at end of archive.
+    bool next(lstring& name, size_t& size);
+
+    // Read current member, call at most once after next().
+    bool read(std::string& data);
+
+private:
+    TarReader(const TarReader&);
+    TarReader& operator=(const TarReader&);
+
+    bool skip(size_t length);
+    bool readBlock(char* block, size_t length);
+
+    lstring     my_path;
+    void*       my_gzFile;      // gzFile
+    size_t      my_remain;      // unread bytes of current member
+    size_t      my_padding;     // bytes to next 512 boundary
+};
@@ -0,0 +1,170 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: changeImpact.cpp
+// Author: Dennis Lang
+// Desc: Classes affected by changed files: declared there or extending/implementing those.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "changeImpact.h"
+#include <string.h>
+
+const uint32_t ChangeImpact::NO_FILE;
+
+//-------------------------------------------------------------------------------------------------
+ChangeImpact::ChangeImpact() :
+    my_graph(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+const char* ChangeImpact::baseName(const char* path)
+{
+    const char* name = path;
+    for (const char* ptr = path; *ptr != '\0'; ptr++)
+        if (*ptr == '/' || *ptr == '\\')
+            name = ptr + 1;
+    return name;
+}
+
+//-------------------------------------------------------------------------------------------------
+void ChangeImpact::build(const GraphSnapshot& graph)
+{
+    my_graph = &graph;
+    my_byName.clear();
+    my_byName.reserve(graph.fileCount());
+    my_classFile.assign(graph.classCount(), NO_FILE);
+    for (size_t fileIdx = 0; fileIdx != graph.fileCount(); fileIdx++)
+    {
+        my_byName[baseName(graph.filePath(fileIdx))].push_back((uint32_t)fileIdx);
+
+        size_t count;
+        const uint32_t* classes = graph.fileClasses(fileIdx, count);
+        for (size_t idx = 0; idx != count; idx++)
+            my_classFile[classes[idx]] = (uint32_t)fileIdx;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void ChangeImpact::findFiles(const lstring& path, std::vector<uint32_t>& files) const
+{
+    files.clear();
+    if (my_graph == NULL)
+        return;
+
+    // git and find paths may start with ./
+    const char* findPath = path;
+    while (findPath[0] == '.' && (findPath[1] == '/' || findPath[1] == '\\'))
+        findPath += 2;
+    size_t findLen = strlen(findPath);
+
+    FileIndex::const_iterator iter = my_byName.find(baseName(findPath));
+    if (iter == my_byName.end())
+        return;
+
+    for (size_t idx = 0; idx != iter->second.size(); idx++)
+    {
+        const char* filePath = my_graph->filePath(iter->second[idx]);
+        size_t fileLen = strlen(filePath);
+        if (fileLen < findLen || strcmp(filePath + fileLen - findLen, findPath) != 0)
+            continue;
+        char sep = (fileLen == findLen) ? '/' : filePath[fileLen - findLen - 1];
+        if (sep == '/' || sep == '\\' || findPath[0] == '/')
+            files.push_back(iter->second[idx]);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t ChangeImpact::affected(const PathList& changedPaths, AffectedList& affected) const
+{
+    affected.clear();
+    if (my_graph == NULL)
+        return 0;
+
+    const uint32_t UNSEEN = (uint32_t)-1;
+    std::vector<uint32_t> distance(my_graph->classCount(), UNSEEN);
+    std::vector<uint32_t> files;
+    size_t matched = 0;
+    for (size_t idx = 0; idx != changedPaths.size(); idx++)
+    {
+        findFiles(changedPaths[idx], files);
+        if (!files.empty())
+            matched++;
+        for (size_t fIdx = 0; fIdx != files.size(); fIdx++)
+        {
+            size_t count;
+            const uint32_t* classes = my_graph->fileClasses(files[fIdx], count);
+            for (size_t cIdx = 0; cIdx != count; cIdx++)
+            {
+                if (distance[classes[cIdx]] == UNSEEN)
+                {
+                    distance[classes[cIdx]] = 0;
+                    Affected seed = { classes[cIdx], 0 };
+                    affected.push_back(seed);
+                }
+            }
+        }
+    }
+
+    // affected doubles as the queue.
+    const GraphSnapshot::Edge kinds[] = { GraphSnapshot::CHILDREN, GraphSnapshot::IMPLEMENTERS };
+    for (size_t head = 0; head != affected.size(); head++)
+    {
+        Affected node = affected[head];
+        for (int kind = 0; kind != 2; kind++)
+        {
+            size_t count;
+            const uint32_t* edges = my_graph->edges(kinds[kind], node.classIdx, count);
+            for (size_t idx = 0; idx != count; idx++)
+            {
+                if (distance[edges[idx]] == UNSEEN)
+                {
+                    distance[edges[idx]] = node.distance + 1;
+                    Affected next = { edges[idx], node.distance + 1 };
+                    affected.push_back(next);
+                }
+            }
+        }
+    }
+    return matched;
+}
+
+//-------------------------------------------------------------------------------------------------
+void ChangeImpact::writeText(const AffectedList& affected, std::ostream& out) const
+{
+    for (size_t idx = 0; idx != affected.size(); idx++)
+    {
+        uint32_t classIdx = affected[idx].classIdx;
+        out << affected[idx].distance << "\t" << my_graph->name(classIdx) << "\t";
+        if (my_classFile[classIdx] != NO_FILE)
+            out << my_graph->filePath(my_classFile[classIdx]) << "\n";
+        else
+            out << my_graph->file(classIdx) << "\n";
+    }
+}
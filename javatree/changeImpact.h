@@ -0,0 +1,90 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: changeImpact.h
+// Author: Dennis Lang
+// Desc: Classes affected by changed files: declared there or extending/implementing those.
+//
+// Usage:
+//      ChangeImpact impact;
+//      impact.build(snapshot);
+//      impact.affected(changedFiles, affectedClasses);
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "graphSnapshot.h"
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Reverse index from file name to the snapshot's files, so changed paths
+// from git or a build tool (relative, any prefix) find the files the scan
+// recorded. The classes declared in those files seed one breadth first
+// walk over child and implementer links, every class is visited once
+// with its shortest distance from a changed class.
+class ChangeImpact
+{
+public:
+    struct Affected
+    {
+        uint32_t classIdx;
+        uint32_t distance;          // 0 = declared in changed file
+    };
+    typedef std::vector<Affected> AffectedList;
+    typedef std::vector<lstring> PathList;
+
+    ChangeImpact();
+
+    // Index file names of graph, graph must stay open.
+    void build(const GraphSnapshot& graph);
+
+    // Files whose path is path or ends with '/' + path.
+    void findFiles(const lstring& path, std::vector<uint32_t>& files) const;
+
+    // Affected classes in walk order, return count of changed paths
+    // that matched a scanned file.
+    size_t affected(const PathList& changedPaths, AffectedList& affected) const;
+
+    // distance, class and scanned file path per line.
+    void writeText(const AffectedList& affected, std::ostream& out) const;
+
+private:
+    typedef std::unordered_map<std::string, std::vector<uint32_t> > FileIndex;
+
+    static const uint32_t NO_FILE = (uint32_t)-1;
+    static const char* baseName(const char* path);
+
+    const GraphSnapshot*    my_graph;
+    FileIndex               my_byName;      // file name to file indices
+    std::vector<uint32_t>   my_classFile;   // declaring file per class
+};
@@ -0,0 +1,167 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: classFileReader.cpp
+// Author: Dennis Lang
+// Desc: Read class name, super class and interfaces from compiled java .class file.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "classFileReader.h"
+
+static const unsigned CLASS_MAGIC = 0xCAFEBABE;
+
+// Constant pool tags
+enum
+{
+    CONSTANT_Utf8 = 1, CONSTANT_Integer = 3, CONSTANT_Float = 4, CONSTANT_Long = 5,
+    CONSTANT_Double = 6, CONSTANT_Class = 7, CONSTANT_String = 8, CONSTANT_Fieldref = 9,
+    CONSTANT_Methodref = 10, CONSTANT_InterfaceMethodref = 11, CONSTANT_NameAndType = 12,
+    CONSTANT_MethodHandle = 15, CONSTANT_MethodType = 16, CONSTANT_Dynamic = 17,
+    CONSTANT_InvokeDynamic = 18, CONSTANT_Module = 19, CONSTANT_Package = 20
+};
+
+// ---------------------------------------------------------------------------
+// Big endian readers, class files are unaligned.
+inline static unsigned GetU2(const unsigned char* ptr)
+{
+    return (ptr[0] << 8) | ptr[1];
+}
+
+inline static unsigned GetU4(const unsigned char* ptr)
+{
+    return ((unsigned)ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3];
+}
+
+// ---------------------------------------------------------------------------
+// Resolve CONSTANT_Class index to its Utf8 name.
+static bool ClassName(
+    const unsigned char* base,
+    size_t length,
+    const std::vector<size_t>& pool,
+    unsigned classIdx,
+    lstring& name)
+{
+    if (classIdx == 0 || classIdx >= pool.size() || pool[classIdx] == 0)
+        return false;
+    const unsigned char* entry = base + pool[classIdx];
+    if (entry[0] != CONSTANT_Class)
+        return false;
+
+    unsigned utf8Idx = GetU2(entry + 1);
+    if (utf8Idx == 0 || utf8Idx >= pool.size() || pool[utf8Idx] == 0)
+        return false;
+    const unsigned char* utf8 = base + pool[utf8Idx];
+    if (utf8[0] != CONSTANT_Utf8)
+        return false;
+
+    unsigned utf8Len = GetU2(utf8 + 1);
+    if (pool[utf8Idx] + 3 + utf8Len > length)
+        return false;
+    name.assign((const char*)utf8 + 3, utf8Len);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+bool ReadClassFile(const char* data, size_t length, ClassFileInfo& info)
+{
+    const unsigned char* base = (const unsigned char*)data;
+    if (length < 10 || GetU4(base) != CLASS_MAGIC)
+        return false;
+
+    // Constant pool, remember entry offsets, 1 based, long/double use 2 slots.
+    unsigned poolCount = GetU2(base + 8);
+    std::vector<size_t> pool(poolCount, 0);
+    size_t pos = 10;
+    for (unsigned idx = 1; idx < poolCount; idx++)
+    {
+        if (pos >= length)
+            return false;
+        pool[idx] = pos;
+        switch (base[pos])
+        {
+        case CONSTANT_Utf8:
+            if (pos + 3 > length)
+                return false;
+            pos += 3 + GetU2(base + pos + 1);
+            break;
+        case CONSTANT_Class:
+        case CONSTANT_String:
+        case CONSTANT_MethodType:
+        case CONSTANT_Module:
+        case CONSTANT_Package:
+            pos += 3;
+            break;
+        case CONSTANT_MethodHandle:
+            pos += 4;
+            break;
+        case CONSTANT_Integer:
+        case CONSTANT_Float:
+        case CONSTANT_Fieldref:
+        case CONSTANT_Methodref:
+        case CONSTANT_InterfaceMethodref:
+        case CONSTANT_NameAndType:
+        case CONSTANT_Dynamic:
+        case CONSTANT_InvokeDynamic:
+            pos += 5;
+            break;
+        case CONSTANT_Long:
+        case CONSTANT_Double:
+            pos += 9;
+            idx++;
+            break;
+        default:
+            return false;   // unknown tag, can't size entry
+        }
+    }
+
+    if (pos + 8 > length)
+        return false;
+
+    info.accessFlags = GetU2(base + pos);
+    if (!ClassName(base, length, pool, GetU2(base + pos + 2), info.name))
+        return false;
+
+    info.superName.clear();
+    info.sourceFile.clear();
+    ClassName(base, length, pool, GetU2(base + pos + 4), info.superName);
+
+    unsigned interfaceCount = GetU2(base + pos + 6);
+    pos += 8;
+    if (pos + interfaceCount * 2 > length)
+        return false;
+
+    info.interfaces.clear();
+    for (unsigned idx = 0; idx != interfaceCount; idx++)
+    {
+        lstring interfaceName;
+        if (ClassName(base, length, pool, GetU2(base + pos + idx * 2), interfaceName))
+            info.interfaces.push_back(interfaceName);
+    }
+    return true;
+}
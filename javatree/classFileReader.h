@@ -0,0 +1,70 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: classFileReader.h
+// Author: Dennis Lang
+// Desc: Read class name, super class and interfaces from compiled java .class file.
+//
+// Usage:
+//      ClassFileInfo info;
+//      if (ReadClassFile(data, length, info))
+//          ... info.name, info.superName, info.interfaces, info.accessFlags
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include <vector>
+
+// Access flags shared by .class and .dex class definitions.
+const unsigned ACC_PUBLIC     = 0x0001;
+const unsigned ACC_PRIVATE    = 0x0002;
+const unsigned ACC_PROTECTED  = 0x0004;
+const unsigned ACC_STATIC     = 0x0008;
+const unsigned ACC_FINAL      = 0x0010;
+const unsigned ACC_INTERFACE  = 0x0200;
+const unsigned ACC_ABSTRACT   = 0x0400;
+const unsigned ACC_SYNTHETIC  = 0x1000;
+const unsigned ACC_ANNOTATION = 0x2000;
+const unsigned ACC_ENUM       = 0x4000;
+const unsigned ACC_MODULE     = 0x8000;
+
+// Class hierarchy part of a compiled class, names in internal form
+// (java/util/Map$Entry).
+struct ClassFileInfo
+{
+    lstring     name;
+    lstring     superName;      // empty for java/lang/Object and modules
+    std::vector<lstring> interfaces;
+    unsigned    accessFlags;
+    lstring     sourceFile;     // dex source_file_idx, empty if unknown
+};
+
+// Read class header up to interfaces[], rest of file is ignored.
+// Return false if data is not a valid class file.
+bool ReadClassFile(const char* data, size_t length, ClassFileInfo& info);
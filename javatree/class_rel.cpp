@@ -33,6 +33,14 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "class_rel.h"
+#include <algorithm>
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+static bool NameLess(const ClassRelations* lhs, const ClassRelations* rhs)
+{
+    return strcmp(lhs->name(), rhs->name()) < 0;
+}
 
 //-------------------------------------------------------------------------------------------------
 void ClassRelations::add_linkage_to(ClassLinkage& start_linkage, ClassRelations* crel_ptr)
@@ -53,6 +61,38 @@ void ClassRelations::add_linkage_to(ClassLinkage& start_linkage, ClassRelations*
     linkage_ptr->relations = crel_ptr;
 }
 
+//-------------------------------------------------------------------------------------------------
+// Unlink one relation, first linkage is embedded so pull next one forward.
+void ClassRelations::remove_linkage_from(ClassLinkage& start_linkage, ClassRelations* crel_ptr)
+{
+    ClassLinkage* prev_ptr = NULL;
+    ClassLinkage* linkage_ptr = &start_linkage;
+
+    while (linkage_ptr != NULL && linkage_ptr->relations != crel_ptr)
+    {
+        prev_ptr = linkage_ptr;
+        linkage_ptr = linkage_ptr->linkage;
+    }
+
+    if (linkage_ptr == NULL || crel_ptr == NULL)
+        return;
+
+    if (prev_ptr != NULL)
+    {
+        prev_ptr->linkage = linkage_ptr->linkage;
+        delete linkage_ptr;
+    }
+    else if (linkage_ptr->linkage != NULL)
+    {
+        ClassLinkage* next_ptr = linkage_ptr->linkage;
+        *linkage_ptr = *next_ptr;
+        delete next_ptr;
+    }
+    else
+    {
+        linkage_ptr->relations = NULL;
+    }
+}
 
 //-------------------------------------------------------------------------------------------------
 void ClassRelations::remove_interfaces(ClassRelations* crel_ptr)
@@ -130,4 +170,23 @@ ClassLinkage* ClassRelations::find_relation(ClassLinkage&
     return linkage_ptr;
 }
 
+//-------------------------------------------------------------------------------------------------
+void ClassRelations::sort_linkage(ClassLinkage& start_linkage)
+{
+    std::vector<ClassRelations*> relations;
+    for (ClassLinkage* linkage_ptr = &start_linkage; linkage_ptr != NULL; linkage_ptr = linkage_ptr->linkage)
+    {
+        if (linkage_ptr->relations != NULL)
+            relations.push_back(linkage_ptr->relations);
+    }
+    if (relations.size() < 2)
+        return;
 
+    std::stable_sort(relations.begin(), relations.end(), NameLess);
+    size_t idx = 0;
+    for (ClassLinkage* linkage_ptr = &start_linkage; linkage_ptr != NULL; linkage_ptr = linkage_ptr->linkage)
+    {
+        if (linkage_ptr->relations != NULL)
+            linkage_ptr->relations = relations[idx++];
+    }
+}
@@ -34,6 +34,8 @@
 
 #pragma once
 #include "ll_stdhdr.h"
+#include <map>
+#include <vector>
 
 // ---------------------------------------------------------------------------
 class ClassRelations;
@@ -57,10 +59,12 @@ class ClassRelations
     const lstring& modifier() const { return my_modifier; }
     const lstring& file() const { return my_file; }
     void  file(const lstring& file) { my_file = file; }
+    void  modifier(const lstring& modifier) { my_modifier = modifier; }
     
     const ClassLinkage& children() const { return my_children; }
     const ClassLinkage& parents() const { return my_parents; }
     const ClassLinkage& interfaces() const { return my_interfaces; }
+    const ClassLinkage& implementers() const { return my_implementers; }
 
     void  remove_interfaces(void)   { remove_interfaces(this); }
     void  remove_parents(void)      { remove_parents(this); }
@@ -72,6 +76,17 @@ class ClassRelations
         { add_linkage_to(my_parents, crel); }
     void  add_child(ClassRelations* crel)  
         { add_linkage_to(my_children, crel); }
+    void  add_implementer(ClassRelations* crel)
+        { add_linkage_to(my_implementers, crel); }
+
+    void  remove_interface(ClassRelations* crel)
+        { remove_linkage_from(my_interfaces, crel); }
+    void  remove_parent(ClassRelations* crel)
+        { remove_linkage_from(my_parents, crel); }
+    void  remove_child(ClassRelations* crel)
+        { remove_linkage_from(my_children, crel); }
+    void  remove_implementer(ClassRelations* crel)
+        { remove_linkage_from(my_implementers, crel); }
         
     ClassLinkage* find_interface(const ClassRelations* crel)
         { return find_relation(my_interfaces, crel); }
@@ -79,13 +94,20 @@ class ClassRelations
         { return find_relation(my_parents, crel); }
     ClassLinkage* find_child(const ClassRelations* crel)
         { return find_relation(my_children, crel); }
+
+    // Order children and implementers by name, output then does not
+    // depend on the order files were scanned.
+    void  sort_children(void)
+        { sort_linkage(my_children); sort_linkage(my_implementers); }
     
   protected:    
     void  add_linkage_to(ClassLinkage&, ClassRelations*);
+    void  remove_linkage_from(ClassLinkage&, ClassRelations*);
     void  remove_interfaces(ClassRelations*);
     void  remove_parents(ClassRelations*);
     void  remove_children(ClassRelations*);
     ClassLinkage* find_relation(ClassLinkage& link, const ClassRelations*); 
+    void  sort_linkage(ClassLinkage&);
     
     lstring        my_name;
     lstring        my_modifier;
@@ -93,4 +115,9 @@ class ClassRelations
     ClassLinkage    my_children;
     ClassLinkage    my_parents;
     ClassLinkage    my_interfaces;
+    ClassLinkage    my_implementers;    // reverse of my_interfaces
 };
+
+typedef std::map<lstring, ClassRelations*> ClassList;
+typedef std::vector<lstring> StringList;
+typedef std::map<lstring, StringList> FileClassList;    // source path -> classes it declares
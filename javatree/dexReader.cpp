@@ -0,0 +1,189 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: dexReader.cpp
+// Author: Dennis Lang
+// Desc: Read class hierarchy from Android classes.dex class_defs table.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "dexReader.h"
+#include <string.h>
+
+static const unsigned NO_INDEX = 0xffffffff;
+static const size_t HEADER_SIZE = 0x70;
+static const size_t CLASS_DEF_SIZE = 32;
+
+// Header offsets
+enum
+{
+    STRING_IDS_SIZE = 0x38, STRING_IDS_OFF = 0x3c,
+    TYPE_IDS_SIZE = 0x40, TYPE_IDS_OFF = 0x44,
+    CLASS_DEFS_SIZE = 0x60, CLASS_DEFS_OFF = 0x64
+};
+
+// ---------------------------------------------------------------------------
+// Little endian readers, dex tables are aligned but the image may not be.
+inline static unsigned GetU2(const unsigned char* ptr)
+{
+    return ptr[0] | (ptr[1] << 8);
+}
+
+inline static unsigned GetU4(const unsigned char* ptr)
+{
+    return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | ((unsigned)ptr[3] << 24);
+}
+
+//-------------------------------------------------------------------------------------------------
+DexReader::DexReader() :
+    my_base(NULL),
+    my_length(0),
+    my_stringCount(0),
+    my_stringIdsOff(0),
+    my_typeCount(0),
+    my_typeIdsOff(0),
+    my_classCount(0),
+    my_classDefsOff(0)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+// Magic is "dex\n" + 3 digit version + "\0", endian_tag must be little endian.
+bool DexReader::open(const char* data, size_t length)
+{
+    my_base = (const unsigned char*)data;
+    my_length = length;
+    my_classCount = 0;
+
+    if (length < HEADER_SIZE || memcmp(data, "dex\n", 4) != 0 || data[7] != '\0')
+        return false;
+    if (GetU4(my_base + 0x28) != 0x12345678)
+        return false;
+
+    my_stringCount  = GetU4(my_base + STRING_IDS_SIZE);
+    my_stringIdsOff = GetU4(my_base + STRING_IDS_OFF);
+    my_typeCount    = GetU4(my_base + TYPE_IDS_SIZE);
+    my_typeIdsOff   = GetU4(my_base + TYPE_IDS_OFF);
+    unsigned classCount = GetU4(my_base + CLASS_DEFS_SIZE);
+    my_classDefsOff = GetU4(my_base + CLASS_DEFS_OFF);
+
+    if (my_stringIdsOff + (size_t)my_stringCount * 4 > length
+        || my_typeIdsOff + (size_t)my_typeCount * 4 > length
+        || my_classDefsOff + (size_t)classCount * CLASS_DEF_SIZE > length)
+        return false;
+
+    my_classCount = classCount;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// string_data_item is uleb128 utf16 length followed by nul terminated MUTF-8.
+const char* DexReader::stringData(unsigned stringIdx, size_t& length) const
+{
+    if (stringIdx >= my_stringCount)
+        return NULL;
+    size_t pos = GetU4(my_base + my_stringIdsOff + stringIdx * 4);
+    for (int bytes = 0; pos < my_length && bytes != 5; bytes++)
+    {
+        if ((my_base[pos++] & 0x80) == 0)
+            break;
+    }
+    if (pos >= my_length)
+        return NULL;
+
+    const char* str = (const char*)my_base + pos;
+    const char* end = (const char*)memchr(str, '\0', my_length - pos);
+    if (end == NULL)
+        return NULL;
+    length = end - str;
+    return str;
+}
+
+//-------------------------------------------------------------------------------------------------
+const char* DexReader::typeDescriptor(unsigned typeIdx, size_t& length) const
+{
+    if (typeIdx >= my_typeCount)
+        return NULL;
+    return stringData(GetU4(my_base + my_typeIdsOff + typeIdx * 4), length);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Class descriptor Lcom/a/B; to internal name com/a/B
+bool DexReader::typeName(unsigned typeIdx, lstring& name) const
+{
+    size_t length;
+    const char* desc = typeDescriptor(typeIdx, length);
+    if (desc == NULL || length < 3 || desc[0] != 'L' || desc[length - 1] != ';')
+        return false;
+    name.assign(desc + 1, length - 2);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// class_def_item: class_idx, access_flags, superclass_idx, interfaces_off,
+// source_file_idx, annotations_off, class_data_off, static_values_off
+bool DexReader::classInfo(size_t idx, ClassFileInfo& info) const
+{
+    if (idx >= my_classCount)
+        return false;
+    const unsigned char* def = my_base + my_classDefsOff + idx * CLASS_DEF_SIZE;
+
+    if (!typeName(GetU4(def), info.name))
+        return false;
+    info.accessFlags = GetU4(def + 4);
+
+    info.superName.clear();
+    unsigned superIdx = GetU4(def + 8);
+    if (superIdx != NO_INDEX)
+        typeName(superIdx, info.superName);
+
+    // type_list is uint size followed by ushort type_idx[size]
+    info.interfaces.clear();
+    size_t interfacesOff = GetU4(def + 12);
+    if (interfacesOff != 0 && interfacesOff + 4 <= my_length)
+    {
+        size_t count = GetU4(my_base + interfacesOff);
+        if (interfacesOff + 4 + count * 2 <= my_length)
+        {
+            for (size_t iIdx = 0; iIdx != count; iIdx++)
+            {
+                lstring interfaceName;
+                if (typeName(GetU2(my_base + interfacesOff + 4 + iIdx * 2), interfaceName))
+                    info.interfaces.push_back(interfaceName);
+            }
+        }
+    }
+
+    info.sourceFile.clear();
+    unsigned sourceIdx = GetU4(def + 16);
+    size_t length;
+    const char* source = (sourceIdx != NO_INDEX) ? stringData(sourceIdx, length) : NULL;
+    if (source != NULL)
+        info.sourceFile.assign(source, length);
+    return true;
+}
@@ -0,0 +1,77 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: dexReader.h
+// Author: Dennis Lang
+// Desc: Read class hierarchy from Android classes.dex class_defs table.
+//
+// Usage:
+//      DexReader dex;
+//      if (dex.open(data, length))
+//          for (size_t idx = 0; idx != dex.classCount(); idx++)
+//              dex.classInfo(idx, info);
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "classFileReader.h"
+
+// ---------------------------------------------------------------------------
+// View over a dex image held in memory (mapped file or inflated apk member),
+// nothing is copied until classInfo() builds the names.
+class DexReader
+{
+public:
+    DexReader();
+
+    // Validate header and table bounds, data must outlive reader.
+    bool open(const char* data, size_t length);
+
+    size_t classCount() const
+    { return my_classCount; }
+
+    // Class definition at idx, names in internal form (com/a/Outer$Inner).
+    bool classInfo(size_t idx, ClassFileInfo& info) const;
+
+    // Type descriptor (Lcom/a/B;) pointing into dex data.
+    const char* typeDescriptor(unsigned typeIdx, size_t& length) const;
+
+private:
+    const char* stringData(unsigned stringIdx, size_t& length) const;
+    bool typeName(unsigned typeIdx, lstring& name) const;
+
+    const unsigned char* my_base;
+    size_t      my_length;
+    unsigned    my_stringCount;
+    size_t      my_stringIdsOff;
+    unsigned    my_typeCount;
+    size_t      my_typeIdsOff;
+    unsigned    my_classCount;
+    size_t      my_classDefsOff;
+};
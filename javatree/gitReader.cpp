@@ -0,0 +1,274 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: gitReader.cpp
+// Author: Dennis Lang
+// Desc: Read git trees and blobs through a long-lived 'git cat-file --batch' pipe.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "gitReader.h"
+
+#include <iostream>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef HAVE_WIN
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#endif
+
+static const char HEX[] = "0123456789abcdef";
+
+// ---------------------------------------------------------------------------
+// Quote path for /bin/sh
+lstring GitReader::quote(const lstring& str)
+{
+    lstring quoted = "'";
+    for (size_t idx = 0; idx != str.length(); idx++)
+    {
+        if (str[idx] == '\'')
+            quoted += "'\\''";
+        else
+            quoted += str[idx];
+    }
+    return quoted + "'";
+}
+
+//-------------------------------------------------------------------------------------------------
+GitReader::GitReader(const lstring& repoDir) :
+    my_repoDir(repoDir),
+    my_pid(-1),
+    my_oidLen(20),
+    my_toGit(NULL),
+    my_fromGit(NULL)
+{
+    if (my_repoDir.empty())
+        my_repoDir = ".";
+}
+
+//-------------------------------------------------------------------------------------------------
+GitReader::~GitReader()
+{
+    close();
+}
+
+#ifdef HAVE_WIN
+
+bool GitReader::open()
+{
+    std::cerr << "git input not supported on this platform\n";
+    return false;
+}
+
+void GitReader::close()
+{
+}
+
+#else
+
+//-------------------------------------------------------------------------------------------------
+bool GitReader::open()
+{
+    close();
+
+    int toGit[2];
+    int fromGit[2];
+    if (pipe(toGit) != 0)
+        return false;
+    if (pipe(fromGit) != 0)
+    {
+        ::close(toGit[0]);
+        ::close(toGit[1]);
+        return false;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    my_pid = fork();
+    if (my_pid == 0)
+    {
+        dup2(toGit[0], 0);
+        dup2(fromGit[1], 1);
+        ::close(toGit[0]);
+        ::close(toGit[1]);
+        ::close(fromGit[0]);
+        ::close(fromGit[1]);
+        execlp("git", "git", "-C", my_repoDir.c_str(), "cat-file", "--batch", (char*)NULL);
+        _exit(127);
+    }
+
+    ::close(toGit[0]);
+    ::close(fromGit[1]);
+    if (my_pid < 0)
+    {
+        ::close(toGit[1]);
+        ::close(fromGit[0]);
+        return false;
+    }
+
+    my_toGit = fdopen(toGit[1], "w");
+    my_fromGit = fdopen(fromGit[0], "r");
+    return my_toGit != NULL && my_fromGit != NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+void GitReader::close()
+{
+    if (my_toGit != NULL)
+        fclose(my_toGit);
+    if (my_fromGit != NULL)
+        fclose(my_fromGit);
+    my_toGit = NULL;
+    my_fromGit = NULL;
+
+    if (my_pid > 0)
+    {
+        int status;
+        waitpid(my_pid, &status, 0);
+    }
+    my_pid = -1;
+}
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// Request one object, response is "<oid> <type> <size>\n<data>\n" or "<name> missing\n"
+bool GitReader::getObject(const lstring& objName, lstring& type, std::string& data)
+{
+    if (my_toGit == NULL || my_fromGit == NULL)
+        return false;
+
+    fputs(objName.c_str(), my_toGit);
+    fputc('\n', my_toGit);
+    fflush(my_toGit);
+
+    char header[1024];
+    if (fgets(header, sizeof(header), my_fromGit) == NULL)
+        return false;
+
+    char* sizePtr = strrchr(header, ' ');
+    char* typePtr = strchr(header, ' ');
+    if (sizePtr == NULL || typePtr == NULL || sizePtr == typePtr)
+        return false;   // "<name> missing" or "<name> ambiguous"
+
+    my_oidLen = (typePtr - header) / 2;
+    type.assign(typePtr + 1, sizePtr - typePtr - 1);
+    size_t length = (size_t)strtoull(sizePtr + 1, NULL, 10);
+
+    data.resize(length);
+    if (length != 0 && fread(&data[0], 1, length, my_fromGit) != length)
+        return false;
+    fgetc(my_fromGit);     // trailing newline
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Tree object is a list of "<mode> <name>\0<binary oid>" entries.
+size_t GitReader::walkTree(
+    const lstring& treeName,
+    const lstring& basePath,
+    Want_file wantFile,
+    Got_file gotFile)
+{
+    lstring type;
+    std::string tree;
+    if (!getObject(treeName, type, tree) || type != "tree")
+    {
+        std::cerr << "Classtree: Unable to read git tree " << treeName << std::endl;
+        return 0;
+    }
+
+    // Binary object id is 20 (sha1) or 32 (sha256) bytes.
+    size_t oidLen = my_oidLen;
+    size_t fileCount = 0;
+    size_t pos = 0;
+    while (pos < tree.length())
+    {
+        size_t space = tree.find(' ', pos);
+        size_t nul = tree.find('\0', space);
+        if (space == std::string::npos || nul == std::string::npos || nul + oidLen >= tree.length())
+            break;
+
+        lstring mode = tree.substr(pos, space - pos);
+        lstring path = basePath;
+        if (!path.empty())
+            path += "/";
+        path.append(tree, space + 1, nul - space - 1);
+
+        lstring oid;
+        for (size_t idx = nul + 1; idx != nul + 1 + oidLen; idx++)
+        {
+            unsigned char c = (unsigned char)tree[idx];
+            oid += HEX[c >> 4];
+            oid += HEX[c & 0xf];
+        }
+        pos = nul + 1 + oidLen;
+
+        if (mode == "40000")
+        {
+            fileCount += walkTree(oid, path, wantFile, gotFile);
+        }
+        else if (mode != "160000" && mode != "120000" && wantFile(path))
+        {
+            std::string blob;
+            if (getObject(oid, type, blob) && type == "blob")
+            {
+                gotFile(path, blob.data(), blob.length());
+                fileCount++;
+            }
+        }
+    }
+
+    return fileCount;
+}
+
+//-------------------------------------------------------------------------------------------------
+FILE* GitReader::command(const lstring& args) const
+{
+    lstring cmd = "git -C ";
+    cmd += quote(my_repoDir);
+    cmd += " ";
+    cmd += args;
+    return popen(cmd.c_str(), "r");
+}
+
+//-------------------------------------------------------------------------------------------------
+bool GitReader::run(const lstring& args, std::string& output) const
+{
+    output.clear();
+    FILE* pipe = command(args);
+    if (pipe == NULL)
+        return false;
+
+    char buffer[4096];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), pipe)) != 0)
+        output.append(buffer, length);
+    return pclose(pipe) == 0;
+}
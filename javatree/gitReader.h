@@ -0,0 +1,89 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: gitReader.h
+// Author: Dennis Lang
+// Desc: Read git trees and blobs through a long-lived 'git cat-file --batch' pipe.
+//
+// Usage:
+//      GitReader git(repoDir);
+//      if (git.open())
+//          git.walkTree("v1.2:src", "src", WantFile, ParseBlob);
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include <stdio.h>
+#include <string>
+
+class GitReader
+{
+public:
+    // Return true if blob at path should be read.
+    typedef bool (*Want_file)(const lstring& path);
+    // Called with blob content of each wanted file.
+    typedef void (*Got_file)(const lstring& path, const char* data, size_t length);
+
+    GitReader(const lstring& repoDir);
+    ~GitReader();
+
+    // Start 'git -C repoDir cat-file --batch', return true if running.
+    bool open();
+
+    // Stop git process.
+    void close();
+
+    // Read object by name (sha, rev:path, rev^{tree}).
+    // Return false if object is missing.
+    bool getObject(const lstring& objName, lstring& type, std::string& data);
+
+    // Recursively walk tree object, call gotFile for each wanted blob.
+    // Return count of files passed to gotFile.
+    size_t walkTree(const lstring& treeName, const lstring& basePath,
+        Want_file wantFile, Got_file gotFile);
+
+    // Run one-shot git command in repoDir, return its stdout.
+    bool run(const lstring& args, std::string& output) const;
+
+    // Start one-shot git command in repoDir, caller reads and pclose()s stdout.
+    FILE* command(const lstring& args) const;
+
+    // Quote argument for /bin/sh
+    static lstring quote(const lstring& arg);
+
+private:
+    GitReader(const GitReader&);
+    GitReader& operator=(const GitReader&);
+
+    lstring     my_repoDir;
+    int         my_pid;
+    size_t      my_oidLen;      // binary object id length
+    FILE*       my_toGit;       // cat-file stdin
+    FILE*       my_fromGit;     // cat-file stdout
+};
@@ -0,0 +1,250 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: graphDiff.cpp
+// Author: Dennis Lang
+// Desc: Compare two class graph snapshots: added, removed and re-parented classes.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "graphDiff.h"
+#include <algorithm>
+#include <string.h>
+
+static const char* const sVizNodeFill[] = { "palegreen", "lightpink", "lightyellow" };
+
+// ---------------------------------------------------------------------------
+// GraphViz label, package and inner class dots become line breaks.
+static void OutVizName(std::ostream& out, const char* name)
+{
+    out << '"';
+    for (const char* ptr = name; *ptr != '\0'; ptr++)
+    {
+        if (*ptr == '.')
+            out << "\\n";
+        else if (*ptr == '"')
+            out << "\\\"";
+        else
+            out << *ptr;
+    }
+    out << '"';
+}
+
+// ---------------------------------------------------------------------------
+static bool SameNames(const std::vector<const char*>& names1, const std::vector<const char*>& names2)
+{
+    if (names1.size() != names2.size())
+        return false;
+    for (size_t idx = 0; idx != names1.size(); idx++)
+        if (strcmp(names1[idx], names2[idx]) != 0)
+            return false;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+GraphDiff::GraphDiff() :
+    my_old(NULL),
+    my_new(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+// Edge targets of classIdx by name, sorting the indices sorts the names.
+void GraphDiff::edgeNames(const GraphSnapshot& graph, GraphSnapshot::Edge kind, size_t classIdx, NameList& names) const
+{
+    names.clear();
+    if (classIdx >= graph.classCount())
+        return;
+
+    size_t count;
+    const uint32_t* edges = graph.edges(kind, classIdx, count);
+    std::vector<uint32_t> sorted(edges, edges + count);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    for (size_t idx = 0; idx != sorted.size(); idx++)
+        names.push_back(graph.name(sorted[idx]));
+}
+
+//-------------------------------------------------------------------------------------------------
+void GraphDiff::compare(const GraphSnapshot& oldGraph, const GraphSnapshot& newGraph)
+{
+    my_old = &oldGraph;
+    my_new = &newGraph;
+    my_changes.clear();
+
+    size_t oldCount = oldGraph.classCount();
+    size_t newCount = newGraph.classCount();
+    size_t oldIdx = 0;
+    size_t newIdx = 0;
+    NameList oldNames, newNames;
+    while (oldIdx != oldCount || newIdx != newCount)
+    {
+        int cmp = (oldIdx == oldCount) ? 1 : (newIdx == newCount) ? -1
+            : strcmp(oldGraph.name(oldIdx), newGraph.name(newIdx));
+        Change change = { 0, (cmp <= 0) ? oldIdx : oldCount, (cmp >= 0) ? newIdx : newCount };
+        bool oldDeclared = cmp <= 0 && (oldGraph.flags(oldIdx) & GraphSnapshot::CLASS_DECLARED);
+        bool newDeclared = cmp >= 0 && (newGraph.flags(newIdx) & GraphSnapshot::CLASS_DECLARED);
+
+        if (oldDeclared && !newDeclared)
+            change.kind = REMOVED;
+        else if (newDeclared && !oldDeclared)
+            change.kind = ADDED;
+        else if (oldDeclared && newDeclared)
+        {
+            edgeNames(oldGraph, GraphSnapshot::PARENTS, oldIdx, oldNames);
+            edgeNames(newGraph, GraphSnapshot::PARENTS, newIdx, newNames);
+            if (!SameNames(oldNames, newNames))
+                change.kind |= REPARENTED;
+            edgeNames(oldGraph, GraphSnapshot::INTERFACES, oldIdx, oldNames);
+            edgeNames(newGraph, GraphSnapshot::INTERFACES, newIdx, newNames);
+            if (!SameNames(oldNames, newNames))
+                change.kind |= INTERFACES;
+        }
+        if (change.kind != 0)
+            my_changes.push_back(change);
+
+        if (cmp <= 0)
+            oldIdx++;
+        if (cmp >= 0)
+            newIdx++;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t GraphDiff::count(unsigned kind) const
+{
+    size_t found = 0;
+    for (size_t idx = 0; idx != my_changes.size(); idx++)
+        if (my_changes[idx].kind & kind)
+            found++;
+    return found;
+}
+
+//-------------------------------------------------------------------------------------------------
+void GraphDiff::writeText(std::ostream& out) const
+{
+    NameList oldNames, newNames;
+    for (size_t idx = 0; idx != my_changes.size(); idx++)
+    {
+        const Change& change = my_changes[idx];
+        if (change.kind == ADDED)
+        {
+            out << "Added\t" << my_new->name(change.newIdx) << "\t" << my_new->file(change.newIdx) << "\n";
+            continue;
+        }
+        if (change.kind == REMOVED)
+        {
+            out << "Removed\t" << my_old->name(change.oldIdx) << "\t" << my_old->file(change.oldIdx) << "\n";
+            continue;
+        }
+
+        if (change.kind & REPARENTED)
+        {
+            edgeNames(*my_old, GraphSnapshot::PARENTS, change.oldIdx, oldNames);
+            edgeNames(*my_new, GraphSnapshot::PARENTS, change.newIdx, newNames);
+            out << "Reparented\t" << my_new->name(change.newIdx) << "\t";
+            for (size_t nIdx = 0; nIdx != oldNames.size(); nIdx++)
+                out << (nIdx == 0 ? "" : ",") << oldNames[nIdx];
+            out << " -> ";
+            for (size_t nIdx = 0; nIdx != newNames.size(); nIdx++)
+                out << (nIdx == 0 ? "" : ",") << newNames[nIdx];
+            out << "\n";
+        }
+        if (change.kind & INTERFACES)
+        {
+            edgeNames(*my_old, GraphSnapshot::INTERFACES, change.oldIdx, oldNames);
+            edgeNames(*my_new, GraphSnapshot::INTERFACES, change.newIdx, newNames);
+            out << "Interfaces\t" << my_new->name(change.newIdx) << "\t";
+
+            // Merge of sorted lists, +added -removed
+            const char* sep = "";
+            size_t oIdx = 0, nIdx = 0;
+            while (oIdx != oldNames.size() || nIdx != newNames.size())
+            {
+                int cmp = (oIdx == oldNames.size()) ? 1 : (nIdx == newNames.size()) ? -1
+                    : strcmp(oldNames[oIdx], newNames[nIdx]);
+                if (cmp < 0)
+                    out << sep << "-" << oldNames[oIdx];
+                else if (cmp > 0)
+                    out << sep << "+" << newNames[nIdx];
+                if (cmp != 0)
+                    sep = " ";
+                if (cmp <= 0)
+                    oIdx++;
+                if (cmp >= 0)
+                    nIdx++;
+            }
+            out << "\n";
+        }
+    }
+
+    out << count(ADDED) << " added, " << count(REMOVED) << " removed, "
+        << count(REPARENTED) << " re-parented, " << count(INTERFACES) << " interface changes\n";
+}
+
+//-------------------------------------------------------------------------------------------------
+void GraphDiff::writeViz(std::ostream& out) const
+{
+    const GraphSnapshot::Edge kinds[] = { GraphSnapshot::PARENTS, GraphSnapshot::INTERFACES };
+    NameList oldNames, newNames;
+    for (size_t idx = 0; idx != my_changes.size(); idx++)
+    {
+        const Change& change = my_changes[idx];
+        const char* name = (change.kind == REMOVED) ? my_old->name(change.oldIdx) : my_new->name(change.newIdx);
+        int fill = (change.kind == ADDED) ? 0 : (change.kind == REMOVED) ? 1 : 2;
+        OutVizName(out, name);
+        out << "  [fillcolor=" << sVizNodeFill[fill] << "]\n";
+
+        for (int kind = 0; kind != 2; kind++)
+        {
+            edgeNames(*my_old, kinds[kind], change.oldIdx, oldNames);
+            edgeNames(*my_new, kinds[kind], change.newIdx, newNames);
+            const char* shape = (kind == 0) ? "" : ",arrowhead=empty";
+
+            size_t oIdx = 0, nIdx = 0;
+            while (oIdx != oldNames.size() || nIdx != newNames.size())
+            {
+                int cmp = (oIdx == oldNames.size()) ? 1 : (nIdx == newNames.size()) ? -1
+                    : strcmp(oldNames[oIdx], newNames[nIdx]);
+                OutVizName(out, (cmp < 0) ? oldNames[oIdx] : newNames[nIdx]);
+                out << " -> ";
+                OutVizName(out, name);
+                if (cmp < 0)
+                    out << " [color=red,style=dashed" << shape << "]\n";
+                else if (cmp > 0)
+                    out << " [color=green3,penwidth=2.0" << shape << "]\n";
+                else
+                    out << " [color=gray40" << shape << "]\n";
+                if (cmp <= 0)
+                    oIdx++;
+                if (cmp >= 0)
+                    nIdx++;
+            }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: graphDiff.h
+// Author: Dennis Lang
+// Desc: Compare two class graph snapshots: added, removed and re-parented classes.
+//
+// Usage:
+//      GraphDiff diff;
+//      diff.compare(oldSnapshot, newSnapshot);
+//      diff.writeText(std::cout);
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "graphSnapshot.h"
+#include <ostream>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Difference of two snapshots. Both class tables are sorted by name so one
+// linear merge pairs up classes, and edge lists hold indices into that
+// sorted table so sorted edge lists merge the same way. Only declared
+// classes count as added or removed, placeholders for outside types come
+// and go with the classes that name them.
+class GraphDiff
+{
+public:
+    enum { ADDED = 1, REMOVED = 2, REPARENTED = 4, INTERFACES = 8 };
+
+    struct Change
+    {
+        unsigned    kind;           // ADDED, REMOVED or REPARENTED|INTERFACES
+        size_t      oldIdx;         // class index, classCount() if missing
+        size_t      newIdx;
+    };
+    typedef std::vector<Change> ChangeList;
+
+    GraphDiff();
+
+    // Snapshots must stay open while the result is used.
+    void compare(const GraphSnapshot& oldGraph, const GraphSnapshot& newGraph);
+
+    const ChangeList& changes() const
+    { return my_changes; }
+
+    size_t count(unsigned kind) const;
+
+    // One line per change and a summary line.
+    void writeText(std::ostream& out) const;
+
+    // GraphViz nodes and edges of changed classes and their links, new
+    // edges green, removed edges red and dashed. Caller writes the
+    // digraph header and trailer.
+    void writeViz(std::ostream& out) const;
+
+private:
+    typedef std::vector<const char*> NameList;
+
+    void edgeNames(const GraphSnapshot& graph, GraphSnapshot::Edge kind, size_t classIdx, NameList& names) const;
+
+    const GraphSnapshot*    my_old;
+    const GraphSnapshot*    my_new;
+    ChangeList              my_changes;
+};
@@ -0,0 +1,512 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: graphServer.cpp
+// Author: Dennis Lang
+// Desc: Answer class graph queries over a Unix domain socket from a resident snapshot.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "graphServer.h"
+#include "split.h"
+
+#include <iostream>
+#include <sstream>
+#include <regex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#ifndef HAVE_WIN
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+typedef GraphSnapshot::Edge Edge;
+
+static size_t FindSpace(const lstring& str, const char* delimList, size_t begIdx)
+{
+    return str.find_first_of(delimList, begIdx);
+}
+
+// ---------------------------------------------------------------------------
+// Class by exact name, else first class whose name ends in ".name" so
+// --resolve graphs can be queried by simple name.
+static size_t FindClass(const GraphSnapshot& graph, const lstring& name)
+{
+    size_t classIdx = graph.find(name);
+    if (classIdx != graph.classCount())
+        return classIdx;
+
+    for (classIdx = 0; classIdx != graph.classCount(); classIdx++)
+    {
+        const char* className = graph.name(classIdx);
+        size_t length = strlen(className);
+        if (length > name.length() && className[length - name.length() - 1] == '.'
+            && strcmp(className + length - name.length(), name) == 0)
+            return classIdx;
+    }
+    return graph.classCount();
+}
+
+// ---------------------------------------------------------------------------
+// Print subtypes of classIdx below indent, path guards against cycles.
+static void OutSubtree(const GraphSnapshot& graph, size_t classIdx, size_t depth,
+    lstring& indent, std::vector<char>& onPath, std::ostream& out)
+{
+    const Edge kinds[] = { GraphSnapshot::CHILDREN, GraphSnapshot::IMPLEMENTERS };
+    std::vector<uint32_t> subtypes;
+    for (int kind = 0; kind != 2; kind++)
+    {
+        size_t count;
+        const uint32_t* edges = graph.edges(kinds[kind], classIdx, count);
+        subtypes.insert(subtypes.end(), edges, edges + count);
+    }
+
+    onPath[classIdx] = 1;
+    for (size_t idx = 0; idx != subtypes.size(); idx++)
+    {
+        bool last = (idx + 1 == subtypes.size());
+        uint32_t sub = subtypes[idx];
+        out << indent << (last ? "   -" : "   +") << graph.name(sub);
+        if (onPath[sub])
+        {
+            out << " (cycle)\n";
+            continue;
+        }
+        out << "\n";
+        if (depth > 1)
+        {
+            size_t length = indent.length();
+            indent += (last ? "    " : "   |");
+            OutSubtree(graph, sub, depth - 1, indent, onPath, out);
+            indent.resize(length);
+        }
+    }
+    onPath[classIdx] = 0;
+}
+
+// ---------------------------------------------------------------------------
+static void OutAncestors(const GraphSnapshot& graph, size_t classIdx, std::ostream& out)
+{
+    const Edge kinds[] = { GraphSnapshot::PARENTS, GraphSnapshot::INTERFACES };
+    std::vector<size_t> distance(graph.classCount(), 0);
+    std::vector<uint32_t> queue(1, (uint32_t)classIdx);
+    distance[classIdx] = 1;
+
+    for (size_t head = 0; head != queue.size(); head++)
+    {
+        uint32_t node = queue[head];
+        for (int kind = 0; kind != 2; kind++)
+        {
+            size_t count;
+            const uint32_t* edges = graph.edges(kinds[kind], node, count);
+            for (size_t idx = 0; idx != count; idx++)
+            {
+                if (distance[edges[idx]] == 0)
+                {
+                    distance[edges[idx]] = distance[node] + 1;
+                    queue.push_back(edges[idx]);
+                    out << distance[node] << "\t" << graph.name(edges[idx])
+                        << (kind == 0 ? "\textends\n" : "\timplements\n");
+                }
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+static void OutReport(const GraphSnapshot& graph, const lstring& format, std::ostream& out)
+{
+    size_t count;
+    if (format == "names")
+    {
+        for (size_t classIdx = 0; classIdx != graph.classCount(); classIdx++)
+            out << graph.name(classIdx) << "\t" << graph.file(classIdx) << "\n";
+    }
+    else if (format == "viz")
+    {
+        out << "digraph G {\n";
+        for (size_t classIdx = 0; classIdx != graph.classCount(); classIdx++)
+        {
+            const uint32_t* edges = graph.edges(GraphSnapshot::PARENTS, classIdx, count);
+            for (size_t idx = 0; idx != count; idx++)
+                out << "  \"" << graph.name(classIdx) << "\" -> \"" << graph.name(edges[idx]) << "\";\n";
+            edges = graph.edges(GraphSnapshot::INTERFACES, classIdx, count);
+            for (size_t idx = 0; idx != count; idx++)
+                out << "  \"" << graph.name(classIdx) << "\" -> \"" << graph.name(edges[idx])
+                    << "\" [style=dashed];\n";
+        }
+        out << "}\n";
+    }
+    else
+    {
+        // Tree from every class without parents or interfaces.
+        std::vector<char> onPath(graph.classCount(), 0);
+        lstring indent;
+        for (size_t classIdx = 0; classIdx != graph.classCount(); classIdx++)
+        {
+            size_t parents, interfaces;
+            graph.edges(GraphSnapshot::PARENTS, classIdx, parents);
+            graph.edges(GraphSnapshot::INTERFACES, classIdx, interfaces);
+            if (parents == 0 && interfaces == 0)
+            {
+                out << graph.name(classIdx) << "\n";
+                OutSubtree(graph, classIdx, (size_t)-1, indent, onPath, out);
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+GraphServer::GraphServer(const lstring& socketPath, Build_graph buildGraph) :
+    my_socketPath(socketPath),
+    my_buildGraph(buildGraph),
+    my_queries(0),
+    my_generation(0),
+    my_stopping(false),
+    my_listenFd(-1),
+    my_started(time(NULL))
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+GraphServer::~GraphServer()
+{
+    stop();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool GraphServer::publish(std::string& image)
+{
+    std::shared_ptr<Resident> resident(new Resident);
+    if (!resident->snapshot.open(image))
+        return false;
+    resident->impact.build(resident->snapshot);
+    std::atomic_store(&my_graph, Graph(resident));
+    my_generation++;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+GraphServer::Graph GraphServer::graph() const
+{
+    return std::atomic_load(&my_graph);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Writer side, the snapshot is built without touching the published graph.
+bool GraphServer::update(Build_graph buildGraph)
+{
+    std::lock_guard<std::mutex> lock(my_writer);
+    std::string image;
+    return buildGraph != NULL && buildGraph(image) && publish(image);
+}
+
+//-------------------------------------------------------------------------------------------------
+void GraphServer::rescan(std::ostream& out)
+{
+    if (!update(my_buildGraph))
+    {
+        out << "error: rescan failed, keeping generation " << my_generation << "\n";
+        return;
+    }
+    out << "generation " << my_generation << ", " << graph()->snapshot.classCount() << " classes\n";
+}
+
+//-------------------------------------------------------------------------------------------------
+void GraphServer::answer(const lstring& request, std::ostream& out)
+{
+    size_t cmdEnd = request.find(' ');
+    lstring command = request.substr(0, cmdEnd);
+    lstring arg;
+    if (cmdEnd != lstring::npos)
+    {
+        size_t argBeg = request.find_first_not_of(' ', cmdEnd);
+        size_t argEnd = request.find_last_not_of(" \r");
+        if (argBeg != lstring::npos && argEnd >= argBeg)
+            arg = request.substr(argBeg, argEnd - argBeg + 1);
+    }
+    else if (!command.empty() && command[command.length() - 1] == '\r')
+    {
+        command.resize(command.length() - 1);
+    }
+
+    my_queries++;
+    if (command == "rescan")
+    {
+        rescan(out);
+        return;
+    }
+    if (command == "shutdown")
+    {
+        my_stopping = true;
+#ifndef HAVE_WIN
+        if (my_listenFd >= 0)
+            shutdown(my_listenFd, SHUT_RDWR);     // wake accept()
+#endif
+        out << "bye\n";
+        return;
+    }
+
+    Graph resident = this->graph();
+    if (!resident)
+    {
+        out << "error: no graph loaded\n";
+        return;
+    }
+    const GraphSnapshot& graph = resident->snapshot;
+
+    if (command == "subtree" || command == "ancestors")
+    {
+        size_t depth = (size_t)-1;
+        size_t space = arg.find(' ');
+        if (space != lstring::npos)
+        {
+            depth = (size_t)strtoul(arg.c_str() + space + 1, NULL, 10);
+            arg.resize(space);
+        }
+        size_t classIdx = FindClass(graph, arg);
+        if (classIdx == graph.classCount())
+        {
+            out << "error: unknown class " << arg << "\n";
+            return;
+        }
+
+        out << graph.name(classIdx) << "\t" << graph.file(classIdx) << "\n";
+        if (command == "ancestors")
+        {
+            OutAncestors(graph, classIdx, out);
+        }
+        else if (depth != 0)
+        {
+            std::vector<char> onPath(graph.classCount(), 0);
+            lstring indent;
+            OutSubtree(graph, classIdx, depth, indent, onPath, out);
+        }
+    }
+    else if (command == "search")
+    {
+        try
+        {
+            std::regex pattern(arg);
+            for (size_t classIdx = 0; classIdx != graph.classCount(); classIdx++)
+            {
+                if (std::regex_search(graph.name(classIdx), pattern))
+                    out << graph.name(classIdx) << "\t" << graph.file(classIdx) << "\n";
+            }
+        }
+        catch (std::regex_error& ex)
+        {
+            out << "error: bad pattern " << arg << "\n";
+        }
+    }
+    else if (command == "impact")
+    {
+        ChangeImpact::PathList changed;
+        Split paths(arg, " ", FindSpace);
+        changed.assign(paths.begin(), paths.end());
+
+        ChangeImpact::AffectedList affected;
+        size_t matched = resident->impact.affected(changed, affected);
+        resident->impact.writeText(affected, out);
+        out << matched << " of " << changed.size() << " files matched, "
+            << affected.size() << " classes affected\n";
+    }
+    else if (command == "report")
+    {
+        OutReport(graph, arg, out);
+    }
+    else if (command == "stats")
+    {
+        size_t declared = 0;
+        for (size_t classIdx = 0; classIdx != graph.classCount(); classIdx++)
+            if (graph.flags(classIdx) & GraphSnapshot::CLASS_DECLARED)
+                declared++;
+
+        const char* kindNames[] = { "parents", "interfaces", "children", "implementers" };
+        out << "generation\t" << my_generation << "\n"
+            << "classes\t" << graph.classCount() << "\n"
+            << "declared\t" << declared << "\n"
+            << "files\t" << graph.fileCount() << "\n";
+        for (int kind = 0; kind != GraphSnapshot::EDGE_KINDS; kind++)
+        {
+            size_t edgeCount = 0;
+            for (size_t classIdx = 0; classIdx != graph.classCount(); classIdx++)
+            {
+                size_t count;
+                graph.edges((Edge)kind, classIdx, count);
+                edgeCount += count;
+            }
+            out << kindNames[kind] << "\t" << edgeCount << "\n";
+        }
+        out << "queries\t" << my_queries << "\n"
+            << "uptime\t" << (time(NULL) - my_started) << "\n";
+    }
+    else if (!command.empty())
+    {
+        out << "error: unknown request " << command
+            << ", use subtree, ancestors, search, impact, report, stats, rescan or shutdown\n";
+    }
+}
+
+#ifdef HAVE_WIN
+
+bool GraphServer::run()
+{
+    std::cerr << "--serve not supported on this platform\n";
+    return false;
+}
+
+void GraphServer::serveClient(int fd)
+{
+}
+
+void GraphServer::stop()
+{
+}
+
+#else
+
+//-------------------------------------------------------------------------------------------------
+bool GraphServer::run()
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (my_socketPath.length() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "Classtree: Socket path too long " << my_socketPath << std::endl;
+        return false;
+    }
+    strcpy(addr.sun_path, my_socketPath);
+
+    signal(SIGPIPE, SIG_IGN);
+    my_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(my_socketPath);
+    if (my_listenFd < 0
+        || bind(my_listenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0
+        || listen(my_listenFd, 64) != 0)
+    {
+        std::cerr << "Classtree: Unable to listen on " << my_socketPath << " " << strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+
+    std::cerr << "Serving " << my_socketPath << std::endl;
+    while (!my_stopping)
+    {
+        int fd = accept(my_listenFd, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(my_clientLock);
+        my_clientFds.push_back(fd);
+        std::thread(&GraphServer::serveClient, this, fd).detach();
+    }
+
+    stop();
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+static bool WriteAll(int fd, const std::string& data)
+{
+    for (size_t sent = 0; sent < data.length(); )
+    {
+        ssize_t count = write(fd, data.data() + sent, data.length() - sent);
+        if (count <= 0)
+            return false;
+        sent += (size_t)count;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Answer request lines until client closes its side.
+void GraphServer::serveClient(int fd)
+{
+    std::string pending;
+    char buffer[4096];
+    ssize_t length;
+    bool connected = true;
+    while (connected && !my_stopping && (length = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        pending.append(buffer, (size_t)length);
+        size_t eol;
+        while (connected && (eol = pending.find('\n')) != std::string::npos)
+        {
+            std::ostringstream out;
+            answer(pending.substr(0, eol), out);
+            out << "\n";
+            pending.erase(0, eol + 1);
+            connected = WriteAll(fd, out.str());
+        }
+    }
+    if (connected && !pending.empty())
+    {
+        std::ostringstream out;
+        answer(pending, out);
+        out << "\n";
+        WriteAll(fd, out.str());
+    }
+    ::close(fd);
+
+    std::lock_guard<std::mutex> lock(my_clientLock);
+    my_clientFds.erase(std::find(my_clientFds.begin(), my_clientFds.end(), fd));
+    my_clientDone.notify_all();
+}
+
+//-------------------------------------------------------------------------------------------------
+// Close listener, end idle client reads and wait for client threads.
+void GraphServer::stop()
+{
+    if (my_listenFd >= 0)
+    {
+        ::close(my_listenFd);
+        unlink(my_socketPath);
+        my_listenFd = -1;
+    }
+
+    std::unique_lock<std::mutex> lock(my_clientLock);
+    for (size_t idx = 0; idx != my_clientFds.size(); idx++)
+        shutdown(my_clientFds[idx], SHUT_RD);
+    while (!my_clientFds.empty())
+        my_clientDone.wait(lock);
+}
+
+#endif
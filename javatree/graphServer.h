@@ -0,0 +1,121 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: graphServer.h
+// Author: Dennis Lang
+// Desc: Answer class graph queries over a Unix domain socket from a resident snapshot.
+//
+// Usage:
+//      GraphServer server("/tmp/javatree.sock", RescanGraph);
+//      server.publish(image);      // GraphSnapshot::build() of first scan
+//      server.run();               // until a 'shutdown' request
+//
+//      echo "ancestors MainActivity" | nc -U /tmp/javatree.sock
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "graphSnapshot.h"
+#include "changeImpact.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <time.h>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Line oriented query server. Each client gets its own thread, a request is
+// one line and its answer ends with an empty line:
+//
+//      subtree <class> [depth]     subclasses and implementers as a tree
+//      ancestors <class>           parents and interfaces with distance
+//      search <regex>              matching class names and their files
+//      impact <file> [<file>...]   classes declared in or derived from files
+//      report [names|tree|viz]     whole graph, tree is the default
+//      stats                       counts of classes, edges, queries
+//      rescan                      reparse sources and publish new graph
+//      shutdown                    stop accepting clients
+//
+// The graph is an immutable GraphSnapshot behind a shared pointer. Readers
+// take a reference and never lock, a rescan builds the next snapshot on
+// the side and swaps the pointer, queries still running keep the old one.
+class GraphServer
+{
+public:
+    // Published graph and the indexes built once per generation.
+    struct Resident
+    {
+        GraphSnapshot   snapshot;
+        ChangeImpact    impact;
+    };
+    typedef std::shared_ptr<const Resident> Graph;
+    // Reparse sources into snapshot image, return false to keep current graph.
+    typedef bool (*Build_graph)(std::string& image);
+
+    GraphServer(const lstring& socketPath, Build_graph buildGraph);
+    ~GraphServer();
+
+    // Install new graph, image is left empty.
+    bool publish(std::string& image);
+
+    Graph graph() const;
+
+    // Build and publish next graph, writers such as rescan requests and
+    // a file watcher take turns here.
+    bool update(Build_graph buildGraph);
+
+    // Listen and serve clients until shutdown, false if socket fails.
+    bool run();
+
+    // Answer one request, safe from several threads.
+    void answer(const lstring& request, std::ostream& out);
+
+private:
+    GraphServer(const GraphServer&);
+    GraphServer& operator=(const GraphServer&);
+
+    void serveClient(int fd);
+    void rescan(std::ostream& out);
+    void stop();
+
+    lstring                 my_socketPath;
+    Build_graph             my_buildGraph;
+    Graph                   my_graph;           // std::atomic_load/store only
+    std::mutex              my_writer;          // one rescan at a time
+    std::mutex              my_clientLock;
+    std::condition_variable my_clientDone;
+    std::vector<int>        my_clientFds;       // active, under my_clientLock
+    std::atomic<size_t>     my_queries;
+    std::atomic<size_t>     my_generation;
+    std::atomic<bool>       my_stopping;
+    int                     my_listenFd;
+    time_t                  my_started;
+};
@@ -0,0 +1,435 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: graphSnapshot.cpp
+// Author: Dennis Lang
+// Desc: Versioned binary class graph snapshot, mapped and used in place.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "graphSnapshot.h"
+
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <string.h>
+
+static const char SNAPSHOT_MAGIC[8] = "JTGRAPH";
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// ---------------------------------------------------------------------------
+// File layout, all offsets from start of file and 8 byte aligned.
+struct GraphSnapshot::Header
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t byteOrder;                     // SNAPSHOT_BYTE_ORDER as written
+    uint32_t classCount;
+    uint32_t fileCount;
+    uint32_t fileClassCount;
+    uint32_t stringBytes;
+    uint32_t edgeCount[EDGE_KINDS];
+    uint64_t classOff;                      // uint32 name, modifier, file per class
+    uint64_t flagOff;                       // uint8 per class
+    uint64_t edgeStartOff[EDGE_KINDS];      // uint32 [classCount + 1]
+    uint64_t edgeOff[EDGE_KINDS];           // uint32 class index
+    uint64_t fileOff;                       // uint32 path per file
+    uint64_t fileStartOff;                  // uint32 [fileCount + 1]
+    uint64_t fileClassOff;                  // uint32 class index
+    uint64_t stringOff;                     // nul terminated strings
+    uint64_t length;
+};
+
+//-------------------------------------------------------------------------------------------------
+GraphSnapshot::GraphSnapshot() :
+    my_header(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+bool GraphSnapshot::open(const lstring& path)
+{
+    close();
+    if (!my_file.open(path))
+        return false;
+
+    my_header = (const Header*)my_file.data();
+    if (my_file.length() < sizeof(Header) || !validate())
+    {
+        std::cerr << "Classtree: Invalid graph snapshot " << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool GraphSnapshot::open(std::string& image)
+{
+    close();
+    my_file.assign(image);
+    my_header = (const Header*)my_file.data();
+    if (my_file.length() < sizeof(Header) || !validate())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void GraphSnapshot::close()
+{
+    my_file.close();
+    my_header = NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Check sections lie inside file and every string offset and class index
+// is in range, accessors then need no checks.
+bool GraphSnapshot::validate() const
+{
+    const Header& hdr = *my_header;
+    if (memcmp(hdr.magic, SNAPSHOT_MAGIC, sizeof(hdr.magic)) != 0
+        || hdr.version != VERSION || hdr.byteOrder != SNAPSHOT_BYTE_ORDER
+        || hdr.length != my_file.length())
+        return false;
+
+    uint64_t classes = hdr.classCount;
+    uint64_t files = hdr.fileCount;
+    if (hdr.classOff + classes * 12 > hdr.length
+        || hdr.flagOff + classes > hdr.length
+        || hdr.fileOff + files * 4 > hdr.length
+        || hdr.fileStartOff + (files + 1) * 4 > hdr.length
+        || hdr.fileClassOff + (uint64_t)hdr.fileClassCount * 4 > hdr.length
+        || hdr.stringOff + hdr.stringBytes > hdr.length
+        || hdr.stringBytes == 0
+        || my_file.data()[hdr.stringOff + hdr.stringBytes - 1] != '\0')
+        return false;
+
+    for (int kind = 0; kind != EDGE_KINDS; kind++)
+    {
+        if (hdr.edgeStartOff[kind] + (classes + 1) * 4 > hdr.length
+            || hdr.edgeOff[kind] + (uint64_t)hdr.edgeCount[kind] * 4 > hdr.length)
+            return false;
+
+        const uint32_t* start = section<uint32_t>(hdr.edgeStartOff[kind]);
+        const uint32_t* edge = section<uint32_t>(hdr.edgeOff[kind]);
+        if (start[classes] != hdr.edgeCount[kind])
+            return false;
+        for (uint64_t idx = 0; idx != classes; idx++)
+        {
+            if (start[idx] > start[idx + 1])
+                return false;
+        }
+        for (uint32_t idx = 0; idx != hdr.edgeCount[kind]; idx++)
+        {
+            if (edge[idx] >= classes)
+                return false;
+        }
+    }
+
+    const uint32_t* classStr = section<uint32_t>(hdr.classOff);
+    for (uint64_t idx = 0; idx != classes * 3; idx++)
+    {
+        if (classStr[idx] >= hdr.stringBytes)
+            return false;
+    }
+
+    const uint32_t* fileStr = section<uint32_t>(hdr.fileOff);
+    const uint32_t* fileStart = section<uint32_t>(hdr.fileStartOff);
+    const uint32_t* fileClass = section<uint32_t>(hdr.fileClassOff);
+    if (fileStart[files] != hdr.fileClassCount)
+        return false;
+    for (uint64_t idx = 0; idx != files; idx++)
+    {
+        if (fileStr[idx] >= hdr.stringBytes || fileStart[idx] > fileStart[idx + 1])
+            return false;
+    }
+    for (uint32_t idx = 0; idx != hdr.fileClassCount; idx++)
+    {
+        if (fileClass[idx] >= classes)
+            return false;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t GraphSnapshot::classCount() const
+{
+    return (my_header != NULL) ? my_header->classCount : 0;
+}
+
+const char* GraphSnapshot::name(size_t classIdx) const
+{
+    return section<char>(my_header->stringOff) + section<uint32_t>(my_header->classOff)[classIdx * 3];
+}
+
+const char* GraphSnapshot::modifier(size_t classIdx) const
+{
+    return section<char>(my_header->stringOff) + section<uint32_t>(my_header->classOff)[classIdx * 3 + 1];
+}
+
+const char* GraphSnapshot::file(size_t classIdx) const
+{
+    return section<char>(my_header->stringOff) + section<uint32_t>(my_header->classOff)[classIdx * 3 + 2];
+}
+
+unsigned GraphSnapshot::flags(size_t classIdx) const
+{
+    return section<uint8_t>(my_header->flagOff)[classIdx];
+}
+
+//-------------------------------------------------------------------------------------------------
+const uint32_t* GraphSnapshot::edges(Edge kind, size_t classIdx, size_t& count) const
+{
+    const uint32_t* start = section<uint32_t>(my_header->edgeStartOff[kind]);
+    count = start[classIdx + 1] - start[classIdx];
+    return section<uint32_t>(my_header->edgeOff[kind]) + start[classIdx];
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t GraphSnapshot::find(const char* findName) const
+{
+    size_t lo = 0;
+    size_t hi = classCount();
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        int cmp = strcmp(name(mid), findName);
+        if (cmp == 0)
+            return mid;
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return classCount();
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t GraphSnapshot::fileCount() const
+{
+    return (my_header != NULL) ? my_header->fileCount : 0;
+}
+
+const char* GraphSnapshot::filePath(size_t fileIdx) const
+{
+    return section<char>(my_header->stringOff) + section<uint32_t>(my_header->fileOff)[fileIdx];
+}
+
+const uint32_t* GraphSnapshot::fileClasses(size_t fileIdx, size_t& count) const
+{
+    const uint32_t* start = section<uint32_t>(my_header->fileStartOff);
+    count = start[fileIdx + 1] - start[fileIdx];
+    return section<uint32_t>(my_header->fileClassOff) + start[fileIdx];
+}
+
+//-------------------------------------------------------------------------------------------------
+void GraphSnapshot::load(ClassList& clist, FileClassList& fileClassList) const
+{
+    size_t count = classCount();
+    std::vector<ClassRelations*> nodes(count);
+    ClassList::iterator hint = clist.end();
+    for (size_t idx = 0; idx != count; idx++)
+    {
+        lstring className = name(idx);
+        ClassList::iterator iter = clist.find(className);
+        if (iter == clist.end())
+        {
+            // Names are sorted, append is amortized constant.
+            nodes[idx] = new ClassRelations(className, modifier(idx), file(idx));
+            iter = clist.insert(hint, std::make_pair(className, nodes[idx]));
+        }
+        nodes[idx] = iter->second;
+    }
+
+    for (size_t idx = 0; idx != count; idx++)
+    {
+        ClassRelations* crel_ptr = nodes[idx];
+        size_t edgeCnt;
+        const uint32_t* edge = edges(PARENTS, idx, edgeCnt);
+        for (size_t eIdx = 0; eIdx != edgeCnt; eIdx++)
+            crel_ptr->add_parent(nodes[edge[eIdx]]);
+        edge = edges(INTERFACES, idx, edgeCnt);
+        for (size_t eIdx = 0; eIdx != edgeCnt; eIdx++)
+            crel_ptr->add_interface(nodes[edge[eIdx]]);
+        edge = edges(CHILDREN, idx, edgeCnt);
+        for (size_t eIdx = 0; eIdx != edgeCnt; eIdx++)
+            crel_ptr->add_child(nodes[edge[eIdx]]);
+        edge = edges(IMPLEMENTERS, idx, edgeCnt);
+        for (size_t eIdx = 0; eIdx != edgeCnt; eIdx++)
+            crel_ptr->add_implementer(nodes[edge[eIdx]]);
+    }
+
+    for (size_t fileIdx = 0; fileIdx != fileCount(); fileIdx++)
+    {
+        StringList& names = fileClassList[filePath(fileIdx)];
+        size_t classCnt;
+        const uint32_t* classIdx = fileClasses(fileIdx, classCnt);
+        for (size_t idx = 0; idx != classCnt; idx++)
+            names.push_back(nodes[classIdx[idx]]->name());
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot writer helpers
+typedef std::unordered_map<lstring, uint32_t, std::hash<std::string> > StringIndex;
+typedef std::unordered_map<const ClassRelations*, uint32_t> ClassIndex;
+
+static uint32_t InternString(const lstring& str, StringIndex& index, std::string& blob)
+{
+    StringIndex::const_iterator iter = index.find(str);
+    if (iter != index.end())
+        return iter->second;
+    uint32_t offset = (uint32_t)blob.length();
+    blob.append(str.c_str(), str.length() + 1);
+    index[str] = offset;
+    return offset;
+}
+
+static void AppendLinks(const ClassLinkage& links, const ClassIndex& classIndex, std::vector<uint32_t>& edges)
+{
+    for (const ClassLinkage* link_ptr = &links; link_ptr != NULL; link_ptr = link_ptr->linkage)
+    {
+        ClassIndex::const_iterator iter = classIndex.find(link_ptr->relations);
+        if (link_ptr->relations != NULL && iter != classIndex.end())
+            edges.push_back(iter->second);
+    }
+}
+
+// Append array padded to 8 bytes, return its offset.
+template <typename T>
+static uint64_t AppendSection(std::string& image, const std::vector<T>& items)
+{
+    uint64_t offset = image.length();
+    if (!items.empty())
+        image.append((const char*)items.data(), items.size() * sizeof(T));
+    image.append((8 - image.length() % 8) % 8, '\0');
+    return offset;
+}
+
+//-------------------------------------------------------------------------------------------------
+void GraphSnapshot::build(std::string& image, const ClassList& clist, const FileClassList& fileClassList)
+{
+    Header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, SNAPSHOT_MAGIC, sizeof(hdr.magic));
+    hdr.version = VERSION;
+    hdr.byteOrder = SNAPSHOT_BYTE_ORDER;
+
+    ClassIndex classIndex;
+    for (ClassList::const_iterator iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        uint32_t idx = (uint32_t)classIndex.size();
+        classIndex[iter->second] = idx;
+    }
+
+    std::unordered_set<lstring, std::hash<std::string> > declared;
+    for (FileClassList::const_iterator iter = fileClassList.begin(); iter != fileClassList.end(); iter++)
+        declared.insert(iter->second.begin(), iter->second.end());
+
+    StringIndex stringIndex;
+    std::string blob;
+    std::vector<uint32_t> classStr;
+    std::vector<uint8_t> flags;
+    std::vector<uint32_t> edgeStart[EDGE_KINDS];
+    std::vector<uint32_t> edges[EDGE_KINDS];
+    for (ClassList::const_iterator iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        const ClassRelations* crel_ptr = iter->second;
+        classStr.push_back(InternString(crel_ptr->name(), stringIndex, blob));
+        classStr.push_back(InternString(crel_ptr->modifier(), stringIndex, blob));
+        classStr.push_back(InternString(crel_ptr->file(), stringIndex, blob));
+        flags.push_back(declared.count(crel_ptr->name()) ? CLASS_DECLARED : 0);
+
+        for (int kind = 0; kind != EDGE_KINDS; kind++)
+            edgeStart[kind].push_back((uint32_t)edges[kind].size());
+        AppendLinks(crel_ptr->parents(), classIndex, edges[PARENTS]);
+        AppendLinks(crel_ptr->interfaces(), classIndex, edges[INTERFACES]);
+        AppendLinks(crel_ptr->children(), classIndex, edges[CHILDREN]);
+        AppendLinks(crel_ptr->implementers(), classIndex, edges[IMPLEMENTERS]);
+    }
+    for (int kind = 0; kind != EDGE_KINDS; kind++)
+        edgeStart[kind].push_back((uint32_t)edges[kind].size());
+
+    std::vector<uint32_t> fileStr;
+    std::vector<uint32_t> fileStart;
+    std::vector<uint32_t> fileClass;
+    for (FileClassList::const_iterator iter = fileClassList.begin(); iter != fileClassList.end(); iter++)
+    {
+        fileStr.push_back(InternString(iter->first, stringIndex, blob));
+        fileStart.push_back((uint32_t)fileClass.size());
+        for (size_t idx = 0; idx != iter->second.size(); idx++)
+        {
+            ClassList::const_iterator classIter = clist.find(iter->second[idx]);
+            if (classIter != clist.end())
+                fileClass.push_back(classIndex[classIter->second]);
+        }
+    }
+    fileStart.push_back((uint32_t)fileClass.size());
+    if (blob.empty())
+        blob.push_back('\0');
+
+    image.assign((const char*)&hdr, sizeof(hdr));
+    hdr.classCount = (uint32_t)clist.size();
+    hdr.fileCount = (uint32_t)fileStr.size();
+    hdr.fileClassCount = (uint32_t)fileClass.size();
+    hdr.stringBytes = (uint32_t)blob.length();
+    hdr.classOff = AppendSection(image, classStr);
+    hdr.flagOff = AppendSection(image, flags);
+    for (int kind = 0; kind != EDGE_KINDS; kind++)
+    {
+        hdr.edgeCount[kind] = (uint32_t)edges[kind].size();
+        hdr.edgeStartOff[kind] = AppendSection(image, edgeStart[kind]);
+        hdr.edgeOff[kind] = AppendSection(image, edges[kind]);
+    }
+    hdr.fileOff = AppendSection(image, fileStr);
+    hdr.fileStartOff = AppendSection(image, fileStart);
+    hdr.fileClassOff = AppendSection(image, fileClass);
+    hdr.stringOff = AppendSection(image, std::vector<char>(blob.begin(), blob.end()));
+    hdr.length = image.length();
+    image.replace(0, sizeof(hdr), (const char*)&hdr, sizeof(hdr));
+}
+
+//-------------------------------------------------------------------------------------------------
+bool GraphSnapshot::save(const lstring& path, const ClassList& clist, const FileClassList& fileClassList)
+{
+    std::string image;
+    build(image, clist, fileClassList);
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(image.data(), image.length());
+    if (!out.good())
+    {
+        std::cerr << "Classtree: Unable to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: graphSnapshot.h
+// Author: Dennis Lang
+// Desc: Versioned binary class graph snapshot, mapped and used in place.
+//
+// Usage:
+//      GraphSnapshot::save("app.jtg", clist, fileClasses);
+//
+//      GraphSnapshot snapshot;
+//      if (snapshot.open("app.jtg"))
+//          snapshot.load(clist, fileClasses);
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "class_rel.h"
+#include "MappedFile.h"
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Read-only view of a saved class graph. Every section is an array located
+// by its offset from the start of the file, so the mapped image is used as
+// is without parsing or pointer fixups. Classes are stored sorted by name,
+// edges in compressed sparse row form (start index per class into one
+// array of class indices).
+class GraphSnapshot
+{
+public:
+    enum Edge { PARENTS, INTERFACES, CHILDREN, IMPLEMENTERS, EDGE_KINDS };
+    enum { CLASS_DECLARED = 1 };    // class has source file
+
+    GraphSnapshot();
+
+    // Map and validate snapshot, return false if missing or wrong version.
+    bool open(const lstring& path);
+    // Take over image built by build(), image is left empty.
+    bool open(std::string& image);
+    void close();
+
+    size_t classCount() const;
+    const char* name(size_t classIdx) const;
+    const char* modifier(size_t classIdx) const;
+    const char* file(size_t classIdx) const;
+    unsigned flags(size_t classIdx) const;
+
+    // Class indices linked to classIdx.
+    const uint32_t* edges(Edge kind, size_t classIdx, size_t& count) const;
+
+    // Binary search by name, return classCount() if not found.
+    size_t find(const char* name) const;
+
+    size_t fileCount() const;
+    const char* filePath(size_t fileIdx) const;
+    const uint32_t* fileClasses(size_t fileIdx, size_t& count) const;
+
+    // Rebuild class list and file index, classes already present are kept.
+    void load(ClassList& clist, FileClassList& fileClasses) const;
+
+    // Serialize class list into image, same layout as the saved file.
+    static void build(std::string& image, const ClassList& clist, const FileClassList& fileClasses);
+    static bool save(const lstring& path, const ClassList& clist, const FileClassList& fileClasses);
+
+    static const unsigned VERSION = 1;
+
+private:
+    GraphSnapshot(const GraphSnapshot&);
+    GraphSnapshot& operator=(const GraphSnapshot&);
+
+    struct Header;
+    bool validate() const;
+
+    template <typename T>
+    const T* section(uint64_t offset) const
+    { return (const T*)(my_file.data() + offset); }
+
+    MappedFile      my_file;
+    const Header*   my_header;
+};
@@ -0,0 +1,192 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: importGraph.cpp
+// Author: Dennis Lang
+// Desc: Package import graph with prefix filter and cycle detection.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "importGraph.h"
+#include "stronglyConnected.h"
+#include <algorithm>
+#include <ctype.h>
+
+//-------------------------------------------------------------------------------------------------
+PrefixTrie::PrefixTrie() :
+    my_nodes(1)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+void PrefixTrie::add(const lstring& prefix)
+{
+    unsigned node = 0;
+    size_t pos = 0;
+    while (pos < prefix.length())
+    {
+        size_t dot = prefix.find('.', pos);
+        if (dot == lstring::npos)
+            dot = prefix.length();
+        if (dot != pos)
+        {
+            lstring segment = prefix.substr(pos, dot - pos);
+            std::map<lstring, unsigned>::const_iterator iter = my_nodes[node].next.find(segment);
+            if (iter == my_nodes[node].next.end())
+            {
+                unsigned child = (unsigned)my_nodes.size();
+                my_nodes[node].next[segment] = child;
+                my_nodes.push_back(Node());
+                node = child;
+            }
+            else
+            {
+                node = iter->second;
+            }
+        }
+        pos = dot + 1;
+    }
+    if (node != 0)
+        my_nodes[node].terminal = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool PrefixTrie::matches(const lstring& name) const
+{
+    if (empty())
+        return true;
+
+    unsigned node = 0;
+    size_t pos = 0;
+    while (pos < name.length())
+    {
+        size_t dot = name.find('.', pos);
+        if (dot == lstring::npos)
+            dot = name.length();
+        std::map<lstring, unsigned>::const_iterator iter = my_nodes[node].next.find(name.substr(pos, dot - pos));
+        if (iter == my_nodes[node].next.end())
+            return false;
+        node = iter->second;
+        if (my_nodes[node].terminal)
+            return true;
+        pos = dot + 1;
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+unsigned ImportGraph::addPackage(const lstring& name)
+{
+    std::map<lstring, unsigned>::const_iterator iter = my_ids.find(name);
+    if (iter != my_ids.end())
+        return iter->second;
+
+    unsigned id = (unsigned)my_names.size();
+    my_ids[name] = id;
+    my_names.push_back(name);
+    my_edges.push_back(IdList());
+    return id;
+}
+
+//-------------------------------------------------------------------------------------------------
+void ImportGraph::addImport(unsigned fromId, const lstring& toPackage)
+{
+    unsigned toId = addPackage(toPackage);
+    if (toId != fromId)
+        my_edges[fromId].push_back(toId);
+}
+
+// ---------------------------------------------------------------------------
+struct ByName
+{
+    ByName(const std::vector<lstring>& names) : my_names(names) { }
+    bool operator()(unsigned lhs, unsigned rhs) const
+    { return my_names[lhs] < my_names[rhs]; }
+    const std::vector<lstring>& my_names;
+};
+
+//-------------------------------------------------------------------------------------------------
+// Edges sorted by package name so output is stable.
+void ImportGraph::finalize()
+{
+    for (size_t id = 0; id != my_edges.size(); id++)
+    {
+        IdList& edges = my_edges[id];
+        std::sort(edges.begin(), edges.end(), ByName(my_names));
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        IdList(edges).swap(edges);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void ImportGraph::clear()
+{
+    my_ids.clear();
+    my_names.clear();
+    my_edges.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+// Segments up to first one starting with upper case are the package.
+lstring ImportGraph::packageOf(const lstring& importName)
+{
+    size_t end = 0;
+    size_t pos = 0;
+    while (pos < importName.length())
+    {
+        size_t dot = importName.find('.', pos);
+        if (dot == lstring::npos)
+            dot = importName.length();
+        if (dot == pos || importName[pos] == '*' || isupper((unsigned char)importName[pos]))
+            break;
+        end = dot;
+        pos = dot + 1;
+    }
+    return importName.substr(0, end);
+}
+
+//-------------------------------------------------------------------------------------------------
+void ImportGraph::cycles(CycleList& cycles) const
+{
+    std::vector<unsigned> component;
+    unsigned count = StronglyConnected(my_edges, component);
+
+    CycleList members(count);
+    for (unsigned id = 0; id != component.size(); id++)
+        members[component[id]].push_back(id);
+
+    cycles.clear();
+    for (unsigned idx = 0; idx != count; idx++)
+    {
+        if (members[idx].size() > 1)
+        {
+            std::sort(members[idx].begin(), members[idx].end(), ByName(my_names));
+            cycles.push_back(members[idx]);
+        }
+    }
+}
@@ -0,0 +1,113 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: importGraph.h
+// Author: Dennis Lang
+// Desc: Package import graph with prefix filter and cycle detection.
+//
+// Usage:
+//      PrefixTrie prefixes;
+//      prefixes.add("com.wsi");
+//      ImportGraph graph;
+//      unsigned id = graph.addPackage("com.wsi.map");
+//      if (prefixes.matches("com.wsi.util"))
+//          graph.addImport(id, "com.wsi.util");
+//      graph.finalize();
+//      graph.cycles(cycles);
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include <map>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Set of dotted package prefixes, matched on whole segments so "com.wsi"
+// matches com.wsi.map but not com.wsix. Empty trie matches everything.
+class PrefixTrie
+{
+public:
+    PrefixTrie();
+
+    void add(const lstring& prefix);
+
+    bool empty() const
+    { return my_nodes.size() == 1; }
+
+    bool matches(const lstring& name) const;
+
+private:
+    struct Node
+    {
+        Node() : terminal(false) { }
+        std::map<lstring, unsigned> next;
+        bool terminal;
+    };
+    std::vector<Node> my_nodes;
+};
+
+// ---------------------------------------------------------------------------
+// Package to imported package edges, one id list per package.
+class ImportGraph
+{
+public:
+    typedef std::vector<unsigned> IdList;
+    typedef std::vector<IdList> CycleList;
+
+    // Return id of package, adding it if new.
+    unsigned addPackage(const lstring& name);
+
+    void addImport(unsigned fromId, const lstring& toPackage);
+
+    // Sort and remove duplicate edges, call once all files are added.
+    void finalize();
+
+    size_t packageCount() const
+    { return my_names.size(); }
+
+    const lstring& name(unsigned id) const
+    { return my_names[id]; }
+
+    const IdList& imports(unsigned id) const
+    { return my_edges[id]; }
+
+    // Strongly connected components of two or more packages (Tarjan),
+    // each sorted by name.
+    void cycles(CycleList& cycles) const;
+
+    void clear();
+
+    // Package part of an import, com.a.B.Inner => com.a, com.a.* => com.a
+    static lstring packageOf(const lstring& importName);
+
+private:
+    std::map<lstring, unsigned> my_ids;
+    std::vector<lstring>        my_names;
+    std::vector<IdList>         my_edges;
+};
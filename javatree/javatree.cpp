@@ -39,10 +39,13 @@
 #pragma warning( disable : 4291 )
 
 #include <stdio.h>
+#include <string.h>
 #include <ctype.h>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <set>
 
 #include "ll_stdhdr.h"
 #include "class_rel.h"
@@ -51,20 +54,48 @@
 #include "SwapStream.h"
 #include "split.h"
 #include "javaTree.h"
+#include "gitReader.h"
+#include "archiveReader.h"
+#include "classFileReader.h"
+#include "dexReader.h"
+#include "MappedFile.h"
+#include "graphSnapshot.h"
+#include "importGraph.h"
+#include "subtypeIndex.h"
+#include "graphServer.h"
+#include "graphDiff.h"
+#include "changeImpact.h"
+#include "sourceWatcher.h"
+#include "lazyTree.h"
+#include "tableWriter.h"
+#include "vizGraph.h"
+#include "packageGraph.h"
+#include "svgTree.h"
+#include "vizRender.h"
+#include "splitManifest.h"
+#include "parallelEmit.h"
+#include "MemoryStream.h"
 
 #include <vector>
 #include <map>
 #include <algorithm>
 #include <regex>
+#include <thread>
+#include <atomic>
+#include <unordered_set>
+#include <chrono>
+#include <memory>
+#ifndef HAVE_WIN
+#include <unistd.h>
+#endif
 using namespace std;
 
-typedef std::map<lstring, ClassRelations*> ClassList;
-typedef std::vector<lstring> StringList;
 ClassList clist;
+FileClassList fileClasses;          // source path -> classes it declares
 
 // Runtime switches
 
-enum {GRAPHICS_CHAR=0, TEXT_CHAR=1, SPACE_CHAR=2, HTML_CHAR=3, JAVA_CHAR=4, VIZ_CHAR=5 };
+enum {GRAPHICS_CHAR=0, TEXT_CHAR=1, SPACE_CHAR=2, HTML_CHAR=3, JAVA_CHAR=4, VIZ_CHAR=5, SVG_CHAR=6 };
 
 bool show_names = false;            
 bool show_tree  = true;
@@ -75,14 +106,34 @@ bool allClasses = false;
 bool importPackage = false;
 bool tabularList = false;
 bool fullPath = false;
+bool resolveNames = false;          // --resolve, package qualified names
 int cset        = GRAPHICS_CHAR;
 int nodesPerFile = 0;
+int parseJobs   = 0;                // --jobs=N, 0=one per cpu
 
 lstring outPath;
 lstring codePath;
 lstring title;
 lstring graphName;
-std::ofstream outStream;
+lstring gitRev;                     // --rev=<commit>
+lstring gitHistory;                 // --history=<from>..<to>
+lstring shardOut;                   // --shard-out=<file>
+bool mergeShards = false;           // --merge, inputs are shard files
+lstring saveGraph;                  // --save-graph=<file>
+lstring servePath;                  // --serve=<socket>
+lstring diffGraph;                  // --diff=<old.jtg>[,<new.jtg>]
+lstring impactFiles;                // --impact=<file,...|@list|->
+bool watchSources = false;          // --watch[=<report>]
+lstring watchReport;
+lstring lazyTreeDir;                // --lazy-tree=<dir>
+lstring tableDir;                   // --table-dir=<dir>
+int packageDepth = -1;              // --packages[=depth], -1 class view
+bool parallelEmit = false;          // --parallel-emit, text tree written by offset
+lstring renderFormat;               // --render=svg|png, run dot on -O files
+std::vector<lstring> vizFiles;      // .gv files in outPath, written or unchanged
+std::ostringstream outStream;        // split file content, written through splitManifest
+lstring splitFile;                  // split file being built, empty none
+SplitManifest splitManifest;
 
 // Display stuff
 typedef std::vector<lstring> Indent;
@@ -93,26 +144,30 @@ static char SLASH_CHR      = '\\';
 #else
 static char SLASH_CHR      = '/';
 #endif
-                                // graph     text    spaces   html
-static lstring none[]         = {"    ",    "    ", "    ", "<img src='n.png'>", ""};
-static lstring more[]         = {"   \xb3", "   |", "    ", "<img src='0.png'>", ""};
-static lstring more_and_me[]  = {"   \xc3", "   +", "    ", "<img src='2.png'>", ""};
-static lstring just_me[]      = {"   \xc0", "   -", "    ", "<img src='1.png'>", ""};
+                                // graph     text    spaces   html  java
+static lstring none[]         = {"    ",    "    ", "    ", "",   ""};
+static lstring more[]         = {"   \xb3", "   |", "    ", "",   ""};
+static lstring more_and_me[]  = {"   \xc3", "   +", "    ", "",   ""};
+static lstring just_me[]      = {"   \xc0", "   -", "    ", "",   ""};
 
 static lstring dc("\nClass Tree\n");
 static lstring cc(": ");
-static lstring doc_begin[]        = {""  , ""  , ""  , "<html>", ""};
-static lstring doc_classes[]      = {dc  , dc  , dc  , "<table>", ""};
-static lstring doc_classesChild[]  = {cc  , cc  , cc  , "<td>", ""};
-static lstring doc_classesBLine[] = {""  , ""  , ""  , "<tr><td>", ""};
-static lstring doc_classesELine[] = {"\n", "\n", "\n", "</tr>\n", ""};
-static lstring doc_end[]          = {""  , ""  , ""  , "</table></html>", ""};
+static lstring doc_begin[]        = {""  , ""  , ""  , "", ""};
+static lstring doc_classes[]      = {dc  , dc  , dc  , "", ""};
+static lstring doc_classesChild[]  = {cc  , cc  , cc  , "", ""};
+static lstring doc_classesBLine[] = {""  , ""  , ""  , "", ""};
+static lstring doc_classesELine[] = {"\n", "\n", "\n", "", ""};
+static lstring doc_end[]          = {""  , ""  , ""  , "", ""};
 
 static int sNodeNum = 1;
 static const char sDot[] = ".";
 static const char sNL[] = "\\n";
-static const lstring sPackageTag("package");
-static const lstring sFileTag("file");
+static const lstring sDefaultPackage("_default_");
+
+ImportGraph importGraph;            // -I package imports
+VizGraph vizGraph;                  // -z class tree of current output file
+PackageGraph packageGraph;          // --packages, link weights for -z
+PrefixTrie importPrefixes;          // --import-prefix, empty keeps all
 
 // ---------------------------------------------------------------------------
 // Output GraphViz header.
@@ -152,7 +207,12 @@ ClassRelations* AddClass(
     {
         pCrel = iter->second;
         if (filename != nofile)
+        {
+            // Placeholder from extends/implements is now declared.
+            if (pCrel->file() == nofile)
+                pCrel->modifier(class_modifier);
             pCrel->file(filename);
+        }
     }
     
     return pCrel;
@@ -172,8 +232,60 @@ void add_parent(
     pSuper->add_child(pChild);
 }
 
+// ---------------------------------------------------------------------------
+// Add an interface to class
+void add_interface(
+    ClassRelations* pClass,
+    const lstring& interface_name,
+    const lstring& filename)
+{
+    ClassRelations* pInterface = AddClass(interface_name, interface, filename);
+
+    pClass->add_interface(pInterface);
+    pInterface->add_implementer(pClass);
+}
+
+// ---------------------------------------------------------------------------
+// Text tree output, appended to a string, copied to a buffer or only
+// counted so --parallel-emit can size each root subtree before writing it.
+struct TextSink
+{
+    TextSink(std::string* text_ = NULL, char* dest_ = NULL) :
+        text(text_), dest(dest_), length(0)
+    { }
+
+    void put(const char* str, size_t len)
+    {
+        if (text != NULL)
+            text->append(str, len);
+        else if (dest != NULL)
+            memcpy(dest + length, str, len);
+        length += len;
+    }
+    void put(const lstring& str)
+    { put(str.c_str(), str.length()); }
+
+    // Same as printf("%*.*s", width, width, str)
+    void putField(const lstring& str, size_t width)
+    {
+        if (str.length() >= width)
+            put(str.c_str(), width);
+        else
+        {
+            for (size_t pad = str.length(); pad != width; pad++)
+                put(" ", 1);
+            put(str);
+        }
+    }
+
+    std::string* text;
+    char*  dest;
+    size_t length;
+};
+
 // ---------------------------------------------------------------------------
 void display_other_parents(
+    TextSink& sink,
     const ClassRelations* parent_ptr, 
     const ClassLinkage* first_parent)
 {
@@ -185,8 +297,9 @@ void display_other_parents(
         crel_ptr = link_ptr->relations;
         if (crel_ptr != NULL && crel_ptr != parent_ptr)
         {   
-            lstring name = crel_ptr->name();
-            printf("  (%s)", name.c_str());
+            sink.put("  (", 3);
+            sink.put(crel_ptr->name());
+            sink.put(")", 1);
         }
                 
         link_ptr = link_ptr->linkage;
@@ -194,16 +307,16 @@ void display_other_parents(
 }
 
 // ---------------------------------------------------------------------------
-void  print_indent(const Indent& indent)
+void  print_indent(TextSink& sink, const Indent& indent)
 {
     for (size_t i=0; i < indent.size(); i++)
     {
-        printf("%s", indent[i].c_str());
+        sink.put(indent[i]);
     }
 }
 
 // ---------------------------------------------------------------------------
-void display_children(Indent& indent, size_t width, const ClassRelations* parent_ptr)
+void display_children(TextSink& sink, Indent& indent, size_t width, const ClassRelations* parent_ptr)
 {
     const ClassLinkage* link_ptr = &parent_ptr->children();
     ClassRelations* crel_ptr;
@@ -215,32 +328,120 @@ void display_children(Indent& indent, size_t width, const ClassRelations* parent
         
         if (crel_ptr != NULL)
         {   
-            lstring name = crel_ptr->name();
             indent.push_back(
                 (link_ptr != NULL)? more_and_me[cset] : just_me[cset]);
            
-            fputs(doc_classesBLine[cset].c_str(), stdout);
-            printf("%*.*s%s", 
-                (int)width, (int)width,
-                crel_ptr->file().c_str(),
-                doc_classesChild[cset].c_str()
-                ); 
-            print_indent(indent);
-            printf(" %s", name.c_str());
+            sink.put(doc_classesBLine[cset]);
+            sink.putField(crel_ptr->file(), width);
+            sink.put(doc_classesChild[cset]);
+            print_indent(sink, indent);
+            sink.put(" ", 1);
+            sink.put(crel_ptr->name());
                 
-            display_other_parents(parent_ptr, &crel_ptr->parents());
-            fputs(doc_classesELine[cset], stdout);
+            display_other_parents(sink, parent_ptr, &crel_ptr->parents());
+            sink.put(doc_classesELine[cset]);
 
             indent.pop_back();
             indent.push_back(
                 (link_ptr != NULL)? more[cset] : none[cset]);
             
-            display_children(indent, width, crel_ptr); 
+            display_children(sink, indent, width, crel_ptr); 
             indent.pop_back();
         }
     } 
 }
 
+// ---------------------------------------------------------------------------
+// Root class line and its subtree.
+void display_root(TextSink& sink, size_t width, const ClassRelations* crel_ptr)
+{
+    sink.put(doc_classesBLine[cset]);
+    sink.putField(crel_ptr->file(), width);
+    sink.put(doc_classesChild[cset]);
+    sink.put(" ", 1);
+    sink.put(crel_ptr->name());
+    sink.put(doc_classesELine[cset]);
+    Indent indent;
+    display_children(sink, indent, width, crel_ptr);
+}
+
+// ---------------------------------------------------------------------------
+void html_fputs(const lstring& text)
+{
+    for (size_t idx = 0; idx != text.length(); idx++)
+    {
+        switch (text[idx])
+        {
+        case '<': fputs("&lt;", stdout); break;
+        case '>': fputs("&gt;", stdout); break;
+        case '&': fputs("&amp;", stdout); break;
+        default:  putchar(text[idx]); break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// -h row, class name, file and other parents. The <li> is left open for a
+// child list, html closes it at the next <li> or </ul>.
+void display_html_class(const ClassRelations* parent_ptr, const ClassRelations* crel_ptr)
+{
+    fputs("<li>", stdout);
+    html_fputs(crel_ptr->name());
+    fputs(" <i>", stdout);
+    html_fputs(crel_ptr->file());
+    fputs("</i>", stdout);
+
+    for (const ClassLinkage* link_ptr = &crel_ptr->parents(); link_ptr != NULL; link_ptr = link_ptr->linkage)
+    {
+        if (link_ptr->relations != NULL && link_ptr->relations != parent_ptr)
+        {
+            fputs(" (", stdout);
+            html_fputs(link_ptr->relations->name());
+            putchar(')');
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Nested lists, tree connectors are drawn by outputHtmlTreeStyle css
+// so each row costs the same bytes at any depth.
+void display_html_children(const ClassRelations* parent_ptr)
+{
+    if (parent_ptr->children().relations == NULL)
+    {
+        putchar('\n');
+        return;
+    }
+
+    fputs("<ul>\n", stdout);
+    for (const ClassLinkage* link_ptr = &parent_ptr->children(); link_ptr != NULL; link_ptr = link_ptr->linkage)
+    {
+        if (link_ptr->relations != NULL)
+        {
+            display_html_class(parent_ptr, link_ptr->relations);
+            display_html_children(link_ptr->relations);
+        }
+    }
+    fputs("</ul>\n", stdout);
+}
+
+// ---------------------------------------------------------------------------
+void display_html_tree()
+{
+    fputs("<ul class=\"jt\">\n", stdout);
+
+    for (ClassList::const_iterator iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        const ClassRelations* crel_ptr = iter->second;
+        if (crel_ptr->parents().relations == NULL)
+        {
+            display_html_class(NULL, crel_ptr);
+            display_html_children(crel_ptr);
+        }
+    }
+    fputs("</ul>\n", stdout);
+}
+
 // ---------------------------------------------------------------------------
 size_t display_interfaces(int parentNum, size_t width, const ClassRelations* parent_ptr)
 {
@@ -254,13 +455,11 @@ size_t display_interfaces(int parentNum, size_t width, const ClassRelations* par
         {
             ClassRelations* nextInterface_ptr = interfaces_ptr->relations;
             interfaces_ptr = interfaces_ptr->linkage;
-            if (nextInterface_ptr->modifier() == sFileTag)
-                continue;
             lstring name = nextInterface_ptr->name();
             if (cset == VIZ_CHAR)
             {
-                cout << "\"" << name << "\"  [style=filled, fillcolor=yellow] \n";
-                cout << "\"" << name << "\" -> \"" << parent_ptr->name() << "\" [color=red,penwidth=3.0] \n";
+                vizGraph.addInterface(nextInterface_ptr);
+                vizGraph.addEdge(nextInterface_ptr, parent_ptr, VizGraph::IMPLEMENTS);
             }
             else
             {
@@ -284,17 +483,27 @@ size_t display_children(
     size_t nodeCnt = 0;
     const ClassLinkage* nextChild_ptr = &parent_ptr->children();
     ClassRelations* child_ptr;
-    const char* parendModStr = "";
-    const char* childModStr = "";
 
     if (cset == VIZ_CHAR)
     {
         nodeCnt += display_interfaces(parentNum, width, parent_ptr);
 
-        if (pparent_ptr == NULL)
-            parendModStr = " [fillcolor=cyan1]";
-        else
-            parendModStr = " [fillcolor=cyan4]";
+        // Parents this node is not listed under as a child, and links
+        // closing a cycle into a root package (--packages).
+        if (packageDepth >= 0)
+        {
+            for (const ClassLinkage* link_ptr = &parent_ptr->parents(); link_ptr != NULL; link_ptr = link_ptr->linkage)
+            {
+                if (link_ptr->relations != NULL && link_ptr->relations != pparent_ptr)
+                    vizGraph.addEdge(link_ptr->relations, parent_ptr, VizGraph::EXTENDS);
+            }
+            const PackageGraph::EdgeList& rootLinks = packageGraph.rootLinks();
+            for (size_t idx = 0; idx != rootLinks.size(); idx++)
+            {
+                if (rootLinks[idx].to == parent_ptr)
+                    vizGraph.addEdge(rootLinks[idx].from, parent_ptr, VizGraph::EXTENDS);
+            }
+        }
     }
  
     // Check if any children.
@@ -311,23 +520,7 @@ size_t display_children(
                 lstring chilNname = child_ptr->name();
                 if (cset == VIZ_CHAR)
                 {
-                    ReplaceAll(chilNname, sDot, sNL);
-                    lstring parentName = parent_ptr->name();
-                    ReplaceAll(parentName, sDot, sNL);
-
-                    if (parent_ptr->modifier().find("abstract") != -1)
-                        parendModStr = (pparent_ptr == NULL) ? " [color=green] " : " [fillcolor=chartreuse] ";
-                    if (child_ptr->modifier().find("abstract") != -1)
-                        childModStr = (parent_ptr == NULL) ? " [color=green] " : " [fillcolor=chartreuse] ";
-                    if (child_ptr->modifier().find("public") == -1)
-                        childModStr = " [color=red] ";
-
-                    if (*parendModStr != 0)
-                        cout << "\"" << parentName << "\" " << parendModStr << std::endl;
-                    if (*childModStr != 0)
-                        cout << "\"" << chilNname << "\" " << childModStr << std::endl;
-                    cout << "\"" << parentName << "\" -> \"" << chilNname << "\"\n";
-                    parendModStr = "";
+                    vizGraph.addEdge(parent_ptr, child_ptr, VizGraph::EXTENDS);
                 }
                 else
                 {
@@ -343,31 +536,10 @@ size_t display_children(
     else
     {
         // Single node - no children
-        lstring name = parent_ptr->name();
         if (cset == VIZ_CHAR)
         {
-            if (importPackage)
-            {
-                if (parent_ptr->parents().relations == NULL)
-                    cerr << "Isolated package " << name << std::endl;
-            }
-            else
-            {
-                ReplaceAll(name, sDot, sNL);
-                if (parent_ptr->modifier().find("abstract") != -1)
-                    childModStr = (parent_ptr == NULL) ? " [color=green] " : " [fillcolor=chartreuse] ";
-                if (parent_ptr->modifier().find("public") == -1)
-                    childModStr = " [color=red] ";
-
-                if (*childModStr != 0)
-                    cout << "\"" << name << "\" " << childModStr << std::endl;
-                cout << "\"" << name << "\"\n";
-
-                nodeCnt++;
-            }
-        }
-        else
-        {
+            vizGraph.addNode(parent_ptr);
+            nodeCnt++;
         }
     }
     return nodeCnt;
@@ -384,11 +556,7 @@ size_t count_interfaces(const ClassRelations* parent_ptr)
 
         while (interfaces_ptr != NULL &&  interfaces_ptr->relations != NULL)
         {
-            ClassRelations* nextInterface_ptr = interfaces_ptr->relations;
             interfaces_ptr = interfaces_ptr->linkage;
-            if (nextInterface_ptr->modifier() == sFileTag)
-                continue;
-
             nodeCnt++;
         }
     }
@@ -443,6 +611,29 @@ bool NextFile(std::ostream& out, size_t& nodeCnt, size_t nextNodeCnt)
     return next;
 }
 
+// ---------------------------------------------------------------------------
+// Finish the split file being built, the file is only rewritten when its
+// content differs from the hash kept in the manifest by the last run.
+void CloseSplitFile(SwapStream& swapStream)
+{
+    if (splitFile.empty())
+        return;
+
+    vizGraph.write(cout);
+    vizGraph.clear();
+    outVizTrailer();
+    swapStream.restore();
+
+    if (!splitManifest.isOpen())
+        splitManifest.open(outPath + ".manifest");
+    if (splitManifest.write(splitFile, outStream.str()))
+        vizFiles.push_back(splitFile);
+    else
+        std::cerr << "Failed to open " << splitFile << std::endl;
+    outStream.str("");
+    splitFile.clear();
+}
+
 // ---------------------------------------------------------------------------
 void display_dependences(void)
 {
@@ -472,6 +663,17 @@ void display_dependences(void)
 
     SwapStream swapStream(cout);
 
+    // --parallel-emit, text tree roots collected then written by offset.
+    bool emitRoots = false;
+    if (parallelEmit && cset != VIZ_CHAR && cset != JAVA_CHAR)
+    {
+        emitRoots = ParallelEmit::canWrite(fileno(stdout));
+        if (!emitRoots)
+            std::cerr << "Classtree: --parallel-emit needs output redirected to a file\n";
+    }
+    std::vector<const ClassRelations*> roots;
+    std::string text;
+
     size_t nodeCnt = -1;
     for (iter = clist.begin(); iter != clist.end(); iter++)
     {
@@ -486,21 +688,12 @@ void display_dependences(void)
             {
                 if (NextFile(outStream, nodeCnt, count_children(crel_ptr, NULL)))
                 {
-                    if (outStream.good())
-                    {
-                        outVizTrailer();
-                        swapStream.restore();
-                        outStream.close();
-                    }
+                    CloseSplitFile(swapStream);
                     needHeader = true;
-                    lstring outFile = outPath + crel_ptr->name() + ".gv";
+                    splitFile = outPath + crel_ptr->name() + ".gv";
                     regex dosSpecial("[<,>?]");
-                    outFile = std::regex_replace(outFile, dosSpecial, "_");
-                    outStream.open(outFile);
-                    if (outStream.good())
-                        swapStream.swap(outStream);
-                    else
-                        std::cerr << "Failed to open " << outFile << std::endl;
+                    splitFile = std::regex_replace(splitFile, dosSpecial, "_");
+                    swapStream.swap(outStream);
                 }
                
                 if (needHeader)
@@ -520,29 +713,59 @@ void display_dependences(void)
 
                 display_children(sNodeNum++, fileWidth, crel_ptr, NULL);
             }
+            else if (emitRoots)
+            {
+                roots.push_back(crel_ptr);
+            }
             else
             {
-                fputs(doc_classesBLine[cset], stdout);
-                printf("%*.*s%s %s",       
-                    (int)fileWidth, (int)fileWidth,
-                    crel_ptr->file().c_str(),
-                    doc_classesChild[cset].c_str(),
-                    crel_ptr->name().c_str()
-                    );
-                fputs(doc_classesELine[cset], stdout);
-                Indent indent;
-                display_children(indent, fileWidth, crel_ptr);
+                text.clear();
+                TextSink sink(&text);
+                display_root(sink, fileWidth, crel_ptr);
+                fwrite(text.data(), 1, text.length(), stdout);
             }
         }            
     }
 
+    if (emitRoots)
+    {
+        cout.flush();
+        fflush(stdout);
+        size_t jobs = (parseJobs > 0) ? parseJobs : std::thread::hardware_concurrency();
+        ParallelEmit emit(jobs);
+        bool okay = emit.write(fileno(stdout), roots.size(),
+            [&](size_t idx)
+            {
+                TextSink sink;
+                display_root(sink, fileWidth, roots[idx]);
+                return sink.length;
+            },
+            [&](size_t idx, char* dest)
+            {
+                TextSink sink(NULL, dest);
+                display_root(sink, fileWidth, roots[idx]);
+            });
+        if (!okay)
+            std::cerr << "Classtree: --parallel-emit failed to write output\n";
+    }
+
     if (cset == VIZ_CHAR)
     {
-        if (outStream.good())
+        if (!splitFile.empty())
+            CloseSplitFile(swapStream);
+        else if (!needHeader)
         {
+            // Unsplit, graph goes to stdout.
+            vizGraph.write(cout);
+            vizGraph.clear();
             outVizTrailer();
-            swapStream.restore();
-            outStream.close();
+        }
+        if (splitManifest.isOpen())
+        {
+            std::cerr << "Split files written " << splitManifest.written()
+                << ", unchanged " << splitManifest.unchanged() << std::endl;
+            if (!splitManifest.close())
+                std::cerr << "Classtree: Failed to write " << outPath << ".manifest\n";
         }
     }
 }
@@ -603,21 +826,102 @@ void release_links(ClassLinkage* first_link)
     } while(last_link != first_link);
 }
 
+// ---------------------------------------------------------------------------
+// Release class children, parents and interfaces.
+void ReleaseClass(ClassRelations* crel_ptr)
+{
+    release_links((ClassLinkage*)&crel_ptr->children());
+    release_links((ClassLinkage*)&crel_ptr->parents());
+    release_links((ClassLinkage*)&crel_ptr->interfaces());
+    release_links((ClassLinkage*)&crel_ptr->implementers());
+    delete crel_ptr;
+}
+
 // ---------------------------------------------------------------------------
 // Release class list children and parents.
 void Release_clist()
 {
-    ClassRelations* crel_ptr;
-    
     ClassList::const_iterator iter;
     for (iter = clist.begin(); iter != clist.end(); iter++)
+        ReleaseClass(iter->second);
+    clist.clear();
+    fileClasses.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Put children in name order so reports and split files are the same for
+// the same classes however the files were found (readdir, --jobs, --watch).
+void SortChildren()
+{
+    ClassList::const_iterator iter;
+    for (iter = clist.begin(); iter != clist.end(); iter++)
+        iter->second->sort_children();
+}
+
+// ---------------------------------------------------------------------------
+// Remove undeclared class once nothing links to it.
+static void ReleaseIfUnused(ClassRelations* crel_ptr)
+{
+    if (crel_ptr->file() == nofile
+        && crel_ptr->children().relations == NULL
+        && crel_ptr->implementers().relations == NULL
+        && crel_ptr->parents().relations == NULL
+        && crel_ptr->interfaces().relations == NULL)
     {
-        crel_ptr = iter->second;
-        release_links((ClassLinkage*)&crel_ptr->children());
-        release_links((ClassLinkage*)&crel_ptr->parents());
-        release_links((ClassLinkage*)&crel_ptr->interfaces());
-        delete crel_ptr;
+        clist.erase(crel_ptr->name());
+        ReleaseClass(crel_ptr);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Cut parent and interface links of class, placeholders left unused go.
+static void UnlinkClass(ClassRelations* crel_ptr)
+{
+    ClassRelations* other_ptr;
+    while ((other_ptr = crel_ptr->parents().relations) != NULL)
+    {
+        crel_ptr->remove_parent(other_ptr);
+        other_ptr->remove_child(crel_ptr);
+        if (other_ptr != crel_ptr)
+            ReleaseIfUnused(other_ptr);
+    }
+    while ((other_ptr = crel_ptr->interfaces().relations) != NULL)
+    {
+        crel_ptr->remove_interface(other_ptr);
+        other_ptr->remove_implementer(crel_ptr);
+        if (other_ptr != crel_ptr)
+            ReleaseIfUnused(other_ptr);
+    }
+}
+
+static void RestoreOtherDecls(const lstring& filepath, const StringList& classNames);
+
+// ---------------------------------------------------------------------------
+// Retract classes declared in file along with their parent and interface
+// links, so the file can be parsed again or dropped.
+void RemoveFileClasses(const lstring& filepath)
+{
+    FileClassList::iterator fileIter = fileClasses.find(filepath);
+    if (fileIter == fileClasses.end())
+        return;
+
+    StringList classNames;
+    classNames.swap(fileIter->second);
+    fileClasses.erase(fileIter);
+
+    for (size_t idx = 0; idx != classNames.size(); idx++)
+    {
+        ClassList::const_iterator iter = clist.find(classNames[idx]);
+        if (iter == clist.end())
+            continue;
+
+        ClassRelations* crel_ptr = iter->second;
+        UnlinkClass(crel_ptr);
+        crel_ptr->file(nofile);
+        ReleaseIfUnused(crel_ptr);
     }
+
+    RestoreOtherDecls(filepath, classNames);
 }
 
 
@@ -684,18 +988,193 @@ lstring&  MakeFullClassName(lstring& outFullName, const StringList& inNames, con
     return outFullName;
 }
 
-struct TableItem
+// ---------------------------------------------------------------------------
+// --focus=<class>[,depth], keep ancestors and descendants within depth
+// links of the focus classes and drop the rest, so any output mode shows
+// just the induced subgraph.
+enum { FOCUS_UP = 1, FOCUS_DOWN = 2, FOCUS_BOTH = 3 };
+StringList focusClasses;            // --focus=<class>[,depth]
+int focusDir = FOCUS_BOTH;          // --focus-dir=up|down|both
+
+typedef std::map<ClassRelations*, int> FocusDepth;
+
+static void FocusVisit(const ClassLinkage& links, int depth, FocusDepth& keep, std::vector<ClassRelations*>& queue)
+{
+    for (const ClassLinkage* link_ptr = &links; link_ptr != NULL; link_ptr = link_ptr->linkage)
+    {
+        if (link_ptr->relations != NULL && keep.find(link_ptr->relations) == keep.end())
+        {
+            keep[link_ptr->relations] = depth;
+            queue.push_back(link_ptr->relations);
+        }
+    }
+}
+
+// Unlink relations that are not kept.
+static void FocusUnlink(ClassRelations* crel_ptr, const FocusDepth& keep)
+{
+    std::vector<ClassRelations*> drop;
+    const ClassLinkage* lists[] = { &crel_ptr->parents(), &crel_ptr->children(), &crel_ptr->interfaces(), &crel_ptr->implementers() };
+    for (int list = 0; list != 4; list++)
+    {
+        drop.clear();
+        for (const ClassLinkage* link_ptr = lists[list]; link_ptr != NULL; link_ptr = link_ptr->linkage)
+        {
+            if (link_ptr->relations != NULL && keep.find(link_ptr->relations) == keep.end())
+                drop.push_back(link_ptr->relations);
+        }
+        for (size_t idx = 0; idx != drop.size(); idx++)
+        {
+            switch (list)
+            {
+            case 0: crel_ptr->remove_parent(drop[idx]);      break;
+            case 1: crel_ptr->remove_child(drop[idx]);       break;
+            case 2: crel_ptr->remove_interface(drop[idx]);   break;
+            case 3: crel_ptr->remove_implementer(drop[idx]); break;
+            }
+        }
+    }
+}
+
+// Find class by name, or by trailing .name when names are qualified.
+static ClassRelations* FindFocusClass(const lstring& name)
+{
+    ClassList::const_iterator iter = clist.find(name);
+    if (iter != clist.end())
+        return iter->second;
+
+    lstring suffix = ".";
+    suffix += name;
+    for (iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        const lstring& key = iter->first;
+        if (key.length() > suffix.length() && key.compare(key.length() - suffix.length(), suffix.length(), suffix) == 0)
+            return iter->second;
+    }
+    return NULL;
+}
+
+// Bounded breadth first search in one direction, depth limit per focus class.
+static void FocusSearch(const std::map<ClassRelations*, int>& starts, int direction, FocusDepth& keep)
+{
+    FocusDepth reached;
+    std::vector<ClassRelations*> queue;
+    std::map<ClassRelations*, int> limit(starts);
+    for (std::map<ClassRelations*, int>::const_iterator iter = starts.begin(); iter != starts.end(); iter++)
+    {
+        reached[iter->first] = 0;
+        queue.push_back(iter->first);
+    }
+
+    for (size_t head = 0; head != queue.size(); head++)
+    {
+        ClassRelations* crel_ptr = queue[head];
+        int depth = reached[crel_ptr];
+        int maxDepth = limit[crel_ptr];
+        if (maxDepth >= 0 && depth >= maxDepth)
+            continue;
+
+        size_t first = queue.size();
+        if (direction == FOCUS_UP)
+        {
+            FocusVisit(crel_ptr->parents(), depth + 1, reached, queue);
+            FocusVisit(crel_ptr->interfaces(), depth + 1, reached, queue);
+        }
+        else
+        {
+            FocusVisit(crel_ptr->children(), depth + 1, reached, queue);
+            FocusVisit(crel_ptr->implementers(), depth + 1, reached, queue);
+        }
+        for (size_t idx = first; idx != queue.size(); idx++)
+            limit[queue[idx]] = maxDepth;
+    }
+    keep.insert(reached.begin(), reached.end());
+}
+
+// ---------------------------------------------------------------------------
+// Keep ancestors and/or descendants of focus classes, return classes kept.
+size_t FocusClassList()
+{
+    std::map<ClassRelations*, int> starts;     // focus class, depth limit or -1
+    for (size_t idx = 0; idx != focusClasses.size(); idx++)
+    {
+        Split split(focusClasses[idx], ",", FindSplit);
+        if (split.empty())
+            continue;
+        ClassRelations* crel_ptr = FindFocusClass(split[0]);
+        if (crel_ptr == NULL)
+            cerr << "Classtree: Focus class not found " << split[0] << endl;
+        else
+            starts[crel_ptr] = (split.size() > 1) ? (int)strtol(split[1], 0, 10) : -1;
+    }
+
+    FocusDepth keep;
+    if (focusDir & FOCUS_UP)
+        FocusSearch(starts, FOCUS_UP, keep);
+    if (focusDir & FOCUS_DOWN)
+        FocusSearch(starts, FOCUS_DOWN, keep);
+
+    std::vector<ClassRelations*> drop;
+    for (ClassList::const_iterator iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        if (keep.find(iter->second) == keep.end())
+            drop.push_back(iter->second);
+        else
+            FocusUnlink(iter->second, keep);
+    }
+    for (size_t idx = 0; idx != drop.size(); idx++)
+    {
+        clist.erase(drop[idx]->name());
+        ReleaseClass(drop[idx]);
+    }
+
+    for (FileClassList::iterator fileIter = fileClasses.begin(); fileIter != fileClasses.end(); )
+    {
+        StringList& names = fileIter->second;
+        StringList kept;
+        for (size_t idx = 0; idx != names.size(); idx++)
+        {
+            if (clist.find(names[idx]) != clist.end())
+                kept.push_back(names[idx]);
+        }
+        names.swap(kept);
+        if (names.empty())
+            fileClasses.erase(fileIter++);
+        else
+            fileIter++;
+    }
+    return clist.size();
+}
+
+// ---------------------------------------------------------------------------
+// Dotted name of "package x.y;" or "import [static] x.y.Z;" statement.
+static lstring StatementName(const lstring& line, size_t pos)
+{
+    pos = line.find_first_not_of(" \t", pos);
+    if (pos != lstring::npos && line.compare(pos, 7, "static ") == 0)
+        pos = line.find_first_not_of(" \t", pos + 7);
+    if (pos == lstring::npos)
+        return lstring();
+    size_t end = line.find_first_of(" \t;", pos);
+    return line.substr(pos, (end == lstring::npos) ? lstring::npos : end - pos);
+}
+
+// Class declaration found by parser, before it is linked into clist.
+struct ClassDecl
 {
-    lstring package;
-    lstring type;   // class or interface
-    lstring className;
-    lstring fullClassName;
+    lstring name;           // full class name, Outer.Inner
     lstring modifier;
     lstring filename;
+    StringList parents;     // extends
+    StringList interfaces;  // implements
+    lstring packageName;    // --resolve, package of source file
+    StringList scope;       // --resolve, enclosing class names
+    StringList imports;     // --resolve, imports of source file
 };
-typedef std::vector<TableItem> TableList;
+typedef std::vector<ClassDecl> ClassDeclList;
 
 TableList tableList;
+TableWriter tableWriter;             // --table-dir, rows written during scan
 
 // ---------------------------------------------------------------------------
 void outputHtmlTableList()
@@ -742,7 +1221,7 @@ void outputHtmlTableList()
 }
 
 // ---------------------------------------------------------------------------
-bool TabularListOfInFile(const char* filepath)
+bool TabularListOfInStream(istream& in, const char* filepath)
 {
     // private static final class LoaderReference extends WeakReference<ClassLoader>
     // private static final class CacheKey implements Cloneable {
@@ -770,7 +1249,6 @@ bool TabularListOfInFile(const char* filepath)
     lstring     class_modifier;
     lstring     filename;
     lstring     packageName;
-    ifstream    in;
     lstring     line;
     lstring     line2;
     JavaReader  reader;
@@ -781,7 +1259,6 @@ bool TabularListOfInFile(const char* filepath)
         return false;   // Ignore non-java files.
 
     try {
-        in.open(filepath);
         if (in.good())
         {
             if (cset == JAVA_CHAR)
@@ -857,7 +1334,10 @@ bool TabularListOfInFile(const char* filepath)
                         item.modifier = class_modifier;
                         item.filename = filename;
 
-                        tableList.push_back(item);
+                        if (tableWriter.isOpen())
+                            tableWriter.add(item);
+                        else
+                            tableList.push_back(item);
 #if 0
                         std::cout
                             << "<tr>"
@@ -938,14 +1418,13 @@ bool TabularListOfInFile(const char* filepath)
                     }
                 }
             }
-            in.close();
 
             // std::cout << "\n</table>\n</body>\n</html>\n";
             return true;
         }
         else
         {
-            cerr << "Classtree: Unable to open " << filepath << endl;
+            cerr << "Classtree: Unable to read " << filepath << endl;
         }
     }
     catch (exception ex)
@@ -959,16 +1438,28 @@ bool TabularListOfInFile(const char* filepath)
 // ---------------------------------------------------------------------------
 bool hasExtension(const lstring& filepath, const char* extn)
 {
-    const char* found = strstr(filepath, extn);
-    if (found != NULL)
-    {
-        return (found[strlen(extn)] == '\0');
-    }
-    return false;
+    size_t extnLen = strlen(extn);
+    return filepath.length() >= extnLen
+        && filepath.compare(filepath.length() - extnLen, extnLen, extn) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// File name shown in reports, url for -j and relative unless -F.
+static lstring ShowFileName(const char* filepath)
+{
+    if (cset == JAVA_CHAR)
+        return FilePathToURL(filepath);
+
+    const char* slashPos = strrchr(filepath, SLASH_CHR);
+    if (slashPos != NULL && !fullPath)
+        return slashPos + 1;
+    return filepath;
 }
 
 // ---------------------------------------------------------------------------
-bool FindClassDefsInFile(const char* filepath)
+// Parse class declarations from java source, does not touch clist so
+// several files can be parsed at once.
+bool ParseClassDecls(istream& in, const char* filepath, ClassDeclList& decls)
 {
     // private static final class LoaderReference extends WeakReference<ClassLoader>
     // private static final class CacheKey implements Cloneable {
@@ -987,18 +1478,16 @@ bool FindClassDefsInFile(const char* filepath)
     static std::regex  allClass_p("[ \t]*(((public|protected|private|abstract|final|static|)[ \t]+)*)(class|interface)[ \t]+([A-Za-z].*)");
     static std::regex  extentds_p("extends[ \t]+([A-Za-z][A-Za-z0-9_]+)");
     static std::regex  implements_p("implements[ \t]+([A-Za-z0-9_., <>]+)");
-    static std::regex package_p("package[ \t]+([A-Za-z0-9_.]+);");
-
     std::smatch     matchs;
     lstring     full_class_name;
     lstring     class_name;
     lstring     class_modifier;
     lstring     filename;
     lstring     packageName;
-    ifstream    in;
+    StringList  imports;
     lstring     line;
     lstring     line2;
-    ClassRelations* crel_ptr = NULL;
+    ClassDecl*  decl_ptr = NULL;
     JavaReader  reader;
 
     std::regex& class_p = allClasses ? allClass_p : pubClass_p;
@@ -1007,21 +1496,9 @@ bool FindClassDefsInFile(const char* filepath)
         return false;   // Ignore non-java files.
 
     try {
-        in.open(filepath);
         if (in.good())
         {
-            if (cset == JAVA_CHAR)
-            {
-                filename = FilePathToURL(filepath);
-            }
-            else
-            {
-                const char* slashPos = strrchr(filepath, SLASH_CHR);
-                if (slashPos != NULL && !fullPath)
-                    filename = slashPos + 1;
-                else
-                    filename = filepath;
-            }
+            filename = ShowFileName(filepath);
 
             int depth = 0;
             StringList classNames;
@@ -1036,15 +1513,23 @@ bool FindClassDefsInFile(const char* filepath)
                 if (rLen >= 4096 || rLen <= 0)
                     continue;   // probably not a valid line.
 
-                // Locate class 
-#if 0
-                if (std::regex_match(line, matchs, package_p, std::regex_constants::match_default))
+                // Package and imports only needed to resolve names.
+                if (resolveNames && depth == 0)
                 {
-                    packageName = std::string(matchs[1]);
+                    size_t pos = line.find_first_not_of(" \t");
+                    if (pos != lstring::npos && line.compare(pos, 8, "package ") == 0)
+                    {
+                        packageName = StatementName(line, pos + 8);
+                        continue;
+                    }
+                    if (pos != lstring::npos && line.compare(pos, 7, "import ") == 0)
+                    {
+                        imports.push_back(StatementName(line, pos + 7));
+                        continue;
+                    }
                 }
-                else 
-#endif
-                   
+
+                // Locate class 
                 if (std::regex_match(line, matchs, class_p, std::regex_constants::match_default))
                 {
                     size_t endIdx = line.find_first_of(";{");
@@ -1076,7 +1561,17 @@ bool FindClassDefsInFile(const char* filepath)
                     if (allClasses || class_modifier.find("public") != string::npos)
                     {
                         MakeFullClassName(full_class_name, classNames, class_name);
-                        crel_ptr = AddClass(full_class_name, class_modifier, filename);
+                        decls.push_back(ClassDecl());
+                        decl_ptr = &decls.back();
+                        decl_ptr->name = full_class_name;
+                        decl_ptr->modifier = class_modifier;
+                        decl_ptr->filename = filename;
+                        if (resolveNames)
+                        {
+                            decl_ptr->packageName = packageName;
+                            decl_ptr->scope = classNames;
+                            decl_ptr->imports = imports;
+                        }
 
                         if (endChar != '{')
                         {
@@ -1114,11 +1609,10 @@ bool FindClassDefsInFile(const char* filepath)
                                     switch (modType)
                                     {
                                     case 1: // extends
-                                        add_parent(crel_ptr, token, nofile);
+                                        decl_ptr->parents.push_back(token);
                                         break;
                                     case 2: // implements
-                                        crel_ptr->add_interface(AddClass(token, interface, nofile));
-                                        // crel_ptr->add_interface(new ClassRelations(token, interface, nofile));
+                                        decl_ptr->interfaces.push_back(token);
                                         break;
                                     }
                                 }
@@ -1148,12 +1642,11 @@ bool FindClassDefsInFile(const char* filepath)
                     }
                 }
             }
-            in.close();
             return true;
         }
         else
         {
-            cerr << "Classtree: Unable to open " << filepath << endl;
+            cerr << "Classtree: Unable to read " << filepath << endl;
         }
     }
     catch (exception ex)
@@ -1163,164 +1656,1329 @@ bool FindClassDefsInFile(const char* filepath)
     }
     return false;
 }
-
 // ---------------------------------------------------------------------------
-bool FindImportPackageInFile(const char* filepath)
+// --resolve, classes are named by package qualified name and extends and
+// implements tokens are resolved through enclosing classes, single type
+// imports, own package and wildcard imports, in that order. Linking waits
+// until every file is read so types declared in later files resolve too.
+typedef std::unordered_set<lstring, std::hash<std::string> > TypeIndex;
+static TypeIndex declaredTypes;         // qualified names of scanned classes
+static ClassDeclList pendingDecls;      // qualified, waiting for ResolveClassDecls
+
+// --history and --watch retract files, keep what each file declared so a
+// class name declared in several files (Util, R) keeps the links of the
+// files that remain.
+typedef std::map<lstring, ClassDeclList> FileDeclList;
+static bool keepFileDecls = false;
+static FileDeclList fileDecls;                      // source path -> its declarations
+static std::multimap<lstring, lstring> declFiles;   // class name -> source path
+
+// Drop type arguments, Map<K,V>.Entry<K,V> => Map.Entry
+static lstring StripTypeArgs(const lstring& name)
 {
+    lstring plain;
+    int depth = 0;
+    for (size_t idx = 0; idx != name.length(); idx++)
+    {
+        char c = name[idx];
+        if (c == '<')
+            depth++;
+        else if (c == '>')
+            depth--;
+        else if (depth == 0 && c != ' ')
+            plain += c;
+    }
+    return plain;
+}
 
-    /*
-    package com.wsi.android.framework.map;
-
-    import java.util.Map;
-    import java.util.Set;
+static lstring Qualify(const lstring& packageName, const lstring& name)
+{
+    if (packageName.empty())
+        return name;
+    lstring qualified = packageName;
+    qualified += ".";
+    qualified += name;
+    return qualified;
+}
 
-    import org.xml.sax.Attributes;
+// Return qualified name of supertype token, or token without type
+// arguments when it is not a scanned or imported type (java.lang).
+static lstring ResolveTypeName(const ClassDecl& decl, const lstring& token)
+{
+    lstring name = StripTypeArgs(token);
+    size_t dotPos = name.find('.');
+    lstring first = name.substr(0, dotPos);
+    lstring rest = (dotPos == lstring::npos) ? lstring() : name.substr(dotPos);
 
-    import android.content.Context;
-    import android.content.SharedPreferences;
+    for (size_t depth = decl.scope.size(); depth != 0; depth--)
+    {
+        lstring outer;
+        for (size_t idx = 0; idx != depth; idx++)
+        {
+            outer += StripTypeArgs(decl.scope[idx]);
+            outer += ".";
+        }
+        lstring candidate = Qualify(decl.packageName, outer + first);
+        if (declaredTypes.count(candidate) != 0)
+            return candidate + rest;
+    }
 
-    import com.google.android.gms.maps.model.LatLng;
-    import com.wsi.android.framework.R;
-    */
-    static std::regex import_p("(package|import) ([A-Za-z0-9_.]+);");
+    for (size_t idx = 0; idx != decl.imports.size(); idx++)
+    {
+        const lstring& import = decl.imports[idx];
+        if (import.length() > first.length()
+            && import.compare(import.length() - first.length(), first.length(), first) == 0
+            && import[import.length() - first.length() - 1] == '.')
+            return import + rest;
+    }
 
-    std::smatch     matchs;
-    lstring         filename;
-    ifstream        in;
+    lstring candidate = Qualify(decl.packageName, first);
+    if (declaredTypes.count(candidate) != 0)
+        return candidate + rest;
+
+    for (size_t idx = 0; idx != decl.imports.size(); idx++)
+    {
+        const lstring& import = decl.imports[idx];
+        if (hasExtension(import, ".*"))
+        {
+            candidate = import.substr(0, import.length() - 1) + first;
+            if (declaredTypes.count(candidate) != 0)
+                return candidate + rest;
+        }
+    }
+    return name;
+}
+
+// ---------------------------------------------------------------------------
+// Link pending --resolve declarations once all files are read.
+void ResolveClassDecls()
+{
+    for (size_t idx = 0; idx != pendingDecls.size(); idx++)
+    {
+        const ClassDecl& decl = pendingDecls[idx];
+        ClassRelations* crel_ptr = AddClass(decl.name, decl.modifier, decl.filename);
+        for (size_t pIdx = 0; pIdx != decl.parents.size(); pIdx++)
+            add_parent(crel_ptr, ResolveTypeName(decl, decl.parents[pIdx]), nofile);
+        for (size_t iIdx = 0; iIdx != decl.interfaces.size(); iIdx++)
+            add_interface(crel_ptr, ResolveTypeName(decl, decl.interfaces[iIdx]), nofile);
+    }
+    pendingDecls.clear();
+    declaredTypes.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Add one declaration, --resolve declarations wait in pendingDecls.
+static void LinkClassDecl(const ClassDecl& decl)
+{
+    ClassRelations* crel_ptr = AddClass(decl.name, decl.modifier, decl.filename);
+    if (resolveNames)
+    {
+        pendingDecls.push_back(decl);
+        return;
+    }
+
+    for (size_t pIdx = 0; pIdx != decl.parents.size(); pIdx++)
+        add_parent(crel_ptr, decl.parents[pIdx], nofile);
+    for (size_t iIdx = 0; iIdx != decl.interfaces.size(); iIdx++)
+        add_interface(crel_ptr, decl.interfaces[iIdx], nofile);
+}
+
+// ---------------------------------------------------------------------------
+// Add parsed class declarations to class list.
+void AddClassDecls(const lstring& filepath, const ClassDeclList& decls)
+{
+    for (size_t idx = 0; idx != decls.size(); idx++)
+    {
+        ClassDecl decl = decls[idx];
+        if (resolveNames)
+        {
+            decl.name = Qualify(decl.packageName, StripTypeArgs(decl.name));
+            declaredTypes.insert(decl.name);
+        }
+        LinkClassDecl(decl);
+        fileClasses[filepath].push_back(decl.name);
+
+        if (keepFileDecls)
+        {
+            fileDecls[filepath].push_back(decl);
+            declFiles.insert(std::make_pair(decl.name, filepath));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Forget what filepath declared, then add back the declarations other
+// files make for the same class names, RemoveFileClasses cut their links.
+static void RestoreOtherDecls(const lstring& filepath, const StringList& classNames)
+{
+    if (!keepFileDecls)
+        return;
+    fileDecls.erase(filepath);
+
+    std::set<lstring> restored;
+    for (size_t idx = 0; idx != classNames.size(); idx++)
+    {
+        const lstring& name = classNames[idx];
+        if (!restored.insert(name).second)
+            continue;
+
+        typedef std::multimap<lstring, lstring>::iterator DeclFileIter;
+        std::pair<DeclFileIter, DeclFileIter> range = declFiles.equal_range(name);
+        for (DeclFileIter iter = range.first; iter != range.second; )
+        {
+            if (iter->second == filepath)
+            {
+                declFiles.erase(iter++);
+                continue;
+            }
+
+            const ClassDeclList& decls = fileDecls[iter->second];
+            for (size_t dIdx = 0; dIdx != decls.size(); dIdx++)
+            {
+                if (decls[dIdx].name == name)
+                    LinkClassDecl(decls[dIdx]);
+            }
+            iter++;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// --resolve --watch, an added or removed type can change how names in
+// unchanged files resolve, so link every kept declaration again.
+static void RelinkFileDecls()
+{
+    FileDeclList::const_iterator fileIter;
+    for (fileIter = fileDecls.begin(); fileIter != fileDecls.end(); fileIter++)
+    {
+        const ClassDeclList& decls = fileIter->second;
+        for (size_t idx = 0; idx != decls.size(); idx++)
+        {
+            ClassList::const_iterator iter = clist.find(decls[idx].name);
+            if (iter != clist.end())
+                UnlinkClass(iter->second);
+        }
+    }
+
+    pendingDecls.clear();
+    for (FileClassList::const_iterator iter = fileClasses.begin(); iter != fileClasses.end(); iter++)
+        declaredTypes.insert(iter->second.begin(), iter->second.end());
+    for (fileIter = fileDecls.begin(); fileIter != fileDecls.end(); fileIter++)
+    {
+        const ClassDeclList& decls = fileIter->second;
+        for (size_t idx = 0; idx != decls.size(); idx++)
+            LinkClassDecl(decls[idx]);
+    }
+    ResolveClassDecls();
+}
+
+// ---------------------------------------------------------------------------
+// Internal class name to tree name, com/a/Outer$Inner => Outer.Inner
+// or com.a.Outer.Inner with --resolve.
+static lstring ClassFileName(const lstring& internalName)
+{
+    size_t slashPos = internalName.rfind('/');
+    lstring name = (slashPos == lstring::npos || resolveNames) ? internalName : internalName.substr(slashPos + 1);
+    std::replace(name.begin(), name.end(), '$', '.');
+    std::replace(name.begin(), name.end(), '/', '.');
+    return name;
+}
+
+// ---------------------------------------------------------------------------
+// Compiled class to declaration, same rules as source parser: public
+// classes unless -A, no java.lang.Object parent and interfaces extend
+// their super interfaces. Anonymous, local and synthetic classes are
+// skipped because they have no source declaration.
+static void AddClassInfoDecl(const ClassFileInfo& info, const lstring& filename, ClassDeclList& decls)
+{
+    if ((info.accessFlags & (ACC_SYNTHETIC | ACC_MODULE)) != 0)
+        return;
+    if (!allClasses && (info.accessFlags & ACC_PUBLIC) == 0)
+        return;
+    for (size_t dollarPos = info.name.find('$'); dollarPos != lstring::npos; dollarPos = info.name.find('$', dollarPos + 1))
+    {
+        if (isdigit(info.name[dollarPos + 1]))
+            return;     // Outer$1 or Outer$1Local
+    }
+
+    decls.push_back(ClassDecl());
+    ClassDecl& decl = decls.back();
+    decl.name = ClassFileName(info.name);
+    decl.filename = filename;
+
+    bool isInterface = (info.accessFlags & ACC_INTERFACE) != 0;
+    if (info.accessFlags & ACC_PUBLIC)
+        decl.modifier += "public ";
+    if ((info.accessFlags & ACC_ABSTRACT) && !isInterface)
+        decl.modifier += "abstract ";
+    if (info.accessFlags & ACC_FINAL)
+        decl.modifier += "final ";
+
+    if (!info.superName.empty() && info.superName != "java/lang/Object")
+        decl.parents.push_back(ClassFileName(info.superName));
+    for (size_t idx = 0; idx != info.interfaces.size(); idx++)
+    {
+        if (isInterface)
+            decl.parents.push_back(ClassFileName(info.interfaces[idx]));
+        else
+            decl.interfaces.push_back(ClassFileName(info.interfaces[idx]));
+    }
+}
+
+// ---------------------------------------------------------------------------
+bool ParseClassFileDecls(const char* data, size_t length, const char* filepath, ClassDeclList& decls)
+{
+    ClassFileInfo info;
+    if (!ReadClassFile(data, length, info))
+    {
+        cerr << "Classtree: Invalid class file " << filepath << endl;
+        return false;
+    }
+    AddClassInfoDecl(info, ShowFileName(filepath), decls);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Every class_def of a dex image, file shown as classes.dex!/Source.java
+// when the dex kept the source file name.
+bool ParseDexDecls(const char* data, size_t length, const char* filepath, ClassDeclList& decls)
+{
+    DexReader dex;
+    if (!dex.open(data, length))
+    {
+        cerr << "Classtree: Invalid dex file " << filepath << endl;
+        return false;
+    }
+
+    lstring dexName = ShowFileName(filepath);
+    ClassFileInfo info;
+    for (size_t idx = 0; idx != dex.classCount(); idx++)
+    {
+        if (!dex.classInfo(idx, info))
+            continue;
+        if (info.sourceFile.empty())
+        {
+            AddClassInfoDecl(info, dexName, decls);
+        }
+        else
+        {
+            lstring sourcePath = filepath;
+            sourcePath += "!/";
+            sourcePath += info.sourceFile;
+            AddClassInfoDecl(info, ShowFileName(sourcePath), decls);
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+static bool IsCompiledFile(const lstring& path)
+{
+    return hasExtension(path, ".class") || hasExtension(path, ".dex");
+}
+
+// ---------------------------------------------------------------------------
+bool ParseCompiledDecls(const char* data, size_t length, const char* filepath, ClassDeclList& decls)
+{
+    if (hasExtension(filepath, ".dex"))
+        return ParseDexDecls(data, length, filepath, decls);
+    return ParseClassFileDecls(data, length, filepath, decls);
+}
+
+// ---------------------------------------------------------------------------
+// Parse .java, .class or .dex held in memory.
+bool ParseSourceDecls(const lstring& path, const std::string& data, ClassDeclList& decls)
+{
+    if (IsCompiledFile(path))
+        return ParseCompiledDecls(data.data(), data.length(), path, decls);
+
+    MemoryStream in(data.data(), data.length());
+    return ParseClassDecls(in, path, decls);
+}
+
+// ---------------------------------------------------------------------------
+bool FindClassDefsInStream(istream& in, const char* filepath)
+{
+    ClassDeclList decls;
+    bool parsed = ParseClassDecls(in, filepath, decls);
+    AddClassDecls(filepath, decls);
+    return parsed;
+}
+
+// ---------------------------------------------------------------------------
+// Add "package" to "import" package edges of one java file, imports of
+// the file's own package and those outside --import-prefix are dropped.
+//
+//  package com.wsi.android.framework.map;
+//  import java.util.Map;
+//  import com.wsi.android.framework.R;
+//
+bool FindImportPackageInStream(istream& in, const char* filepath)
+{
     lstring         line;
-    ClassRelations* child_ptr = NULL;
-    ClassRelations* file_ptr = NULL;
     JavaReader      reader;
     lstring         packageName;
-    lstring         empty;
-
+    unsigned        packageId = 0;
+    bool            havePackage = false;
 
-    if (strstr(filepath, ".java") == NULL)
+    if (!hasExtension(filepath, ".java"))
         return false;   // Ignore non-java files.
 
     try {
-        in.open(filepath);
         if (in.good())
         {
-            if (cset == JAVA_CHAR)
+            // Package and imports precede the first type body.
+            while (reader.getJavaline(in, line).good())
             {
-                filename = FilePathToURL(filepath);
+                size_t pos = line.find_first_not_of(" \t");
+                if (pos == lstring::npos)
+                    continue;
+                if (line.find('{', pos) != lstring::npos)
+                    break;
+
+                if (line.compare(pos, 8, "package ") == 0)
+                {
+                    packageName = StatementName(line, pos + 8);
+                    packageId = importGraph.addPackage(packageName);
+                    havePackage = true;
+                }
+                else if (line.compare(pos, 7, "import ") == 0)
+                {
+                    lstring importName = ImportGraph::packageOf(StatementName(line, pos + 7));
+                    if (importName.empty() || importName == packageName || !importPrefixes.matches(importName))
+                        continue;
+                    if (!havePackage)
+                    {
+                        packageId = importGraph.addPackage(sDefaultPackage);
+                        havePackage = true;
+                    }
+                    importGraph.addImport(packageId, importName);
+                }
             }
-            else
+
+            return true;
+        }
+        else
+        {
+            cerr << "Classtree: Unable to read " << filepath << endl;
+        }
+    }
+    catch (exception ex)
+    {
+        cerr << "Parsing error in file:" << filepath << endl;
+        cerr << ex.what() << std::endl;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Package import graph, edges inside a cycle are drawn red in GraphViz.
+void display_imports(void)
+{
+    importGraph.finalize();
+    ImportGraph::CycleList cycles;
+    importGraph.cycles(cycles);
+
+    std::vector<unsigned> cycleOf(importGraph.packageCount(), 0);
+    for (size_t cIdx = 0; cIdx != cycles.size(); cIdx++)
+        for (size_t idx = 0; idx != cycles[cIdx].size(); idx++)
+            cycleOf[cycles[cIdx][idx]] = (unsigned)cIdx + 1;
+
+    std::vector<unsigned> order(importGraph.packageCount());
+    for (unsigned id = 0; id != order.size(); id++)
+        order[id] = id;
+    std::sort(order.begin(), order.end(), [](unsigned lhs, unsigned rhs)
+        { return importGraph.name(lhs) < importGraph.name(rhs); });
+
+    if (cset == VIZ_CHAR)
+    {
+        outVizHeader();
+        for (size_t idx = 0; idx != order.size(); idx++)
+        {
+            unsigned id = order[idx];
+            const ImportGraph::IdList& imports = importGraph.imports(id);
+            if (cycleOf[id] != 0)
+                cout << "\"" << importGraph.name(id) << "\" [fillcolor=orange]\n";
+            for (size_t iIdx = 0; iIdx != imports.size(); iIdx++)
             {
-                const char* slashPos = strrchr(filename, SLASH_CHR);
-                if (slashPos != NULL)
-                    filename = slashPos + 1;
-                else
-                    filename = filepath;
+                cout << "\"" << importGraph.name(id) << "\" -> \"" << importGraph.name(imports[iIdx]) << "\"";
+                if (cycleOf[id] != 0 && cycleOf[id] == cycleOf[imports[iIdx]])
+                    cout << " [color=red,penwidth=2.0]";
+                cout << "\n";
             }
+        }
+        outVizTrailer();
+    }
+    else
+    {
+        cout << "\nPackage Imports\n";
+        for (size_t idx = 0; idx != order.size(); idx++)
+        {
+            unsigned id = order[idx];
+            const ImportGraph::IdList& imports = importGraph.imports(id);
+            if (imports.empty())
+                continue;
+            cout << importGraph.name(id) << "\n";
+            for (size_t iIdx = 0; iIdx != imports.size(); iIdx++)
+                cout << "    " << importGraph.name(imports[iIdx]) << "\n";
+        }
+    }
 
-            // Read input file lines.
-            while (reader.getJavaline(in, line).good())
+    ostream& report = (cset == VIZ_CHAR) ? cerr : cout;
+    report << "\nPackage Cycles " << cycles.size() << "\n";
+    for (size_t cIdx = 0; cIdx != cycles.size(); cIdx++)
+    {
+        report << "  " << (cIdx + 1) << ":";
+        for (size_t idx = 0; idx != cycles[cIdx].size(); idx++)
+            report << " " << importGraph.name(cycles[cIdx][idx]);
+        report << "\n";
+    }
+    importGraph.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Parse java source stream using active mode (-I, -T or class tree).
+bool ParseJavaStream(istream& in, const char* filepath)
+{
+    if (importPackage)
+        return FindImportPackageInStream(in, filepath);
+    else if (tabularList)
+        return TabularListOfInStream(in, filepath);
+    return FindClassDefsInStream(in, filepath);
+}
+
+// ---------------------------------------------------------------------------
+// Return true if archive member or file can be parsed in active mode.
+static bool WantSourceFile(const lstring& path)
+{
+    if (hasExtension(path, ".java"))
+        return true;
+    return IsCompiledFile(path) && !importPackage && !tabularList;
+}
+
+// ---------------------------------------------------------------------------
+// Parse mapped .class or .dex file.
+bool ParseCompiledFile(const char* filepath)
+{
+    MappedFile map;
+    if (!map.open(filepath))
+    {
+        cerr << "Classtree: Unable to open " << filepath << endl;
+        return false;
+    }
+
+    ClassDeclList decls;
+    bool parsed = ParseCompiledDecls(map.data(), map.length(), filepath, decls);
+    AddClassDecls(filepath, decls);
+    return parsed;
+}
+
+// ---------------------------------------------------------------------------
+bool ParseJavaFile(const char* filepath)
+{
+    if (strstr(filepath, ".java") == NULL)
+        return false;   // Ignore non-java files.
+
+    ifstream in(filepath);
+    if (!in.good())
+    {
+        cerr << "Classtree: Unable to open " << filepath << endl;
+        return false;
+    }
+    return ParseJavaStream(in, filepath);
+}
+
+// ---------------------------------------------------------------------------
+// Return true if inPath (filename part) matches pattern in patternList
+bool FileMatches(const lstring& inPath, const PatternList& patternList)
+{
+    size_t nameStart = inPath.rfind(SLASH_CHR) + 1;
+    if (patternList.empty() || nameStart == 0 || nameStart == inPath.length())
+        return false;
+
+    for (size_t idx = 0; idx != patternList.size(); idx++)
+        if (std::regex_match(inPath.begin() + nameStart, inPath.end(), patternList[idx]))
+            return true;
+
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+static size_t FindClassDefinitions(const lstring& dirname, PatternList ignorePatterns)
+{
+    Directory_files directory(dirname);
+    lstring fullname;
+
+    size_t fileCount = 0;
+    while (directory.more())
+    {
+        directory.fullName(fullname);
+        if (directory.is_directory())
+        {
+            fileCount += FindClassDefinitions(fullname, ignorePatterns);
+        }
+        else if (fullname.length() > 0 && !FileMatches(fullname, ignorePatterns))
+        {
+            if (IsCompiledFile(fullname))
             {
-                size_t rLen = line.length();
-                if (rLen >= 4096 || rLen <= 0)
-                    continue;   // probably not a valid line.
+                if (WantSourceFile(fullname) && ParseCompiledFile(fullname))
+                    fileCount++;
+            }
+            else if (ParseJavaFile(fullname))
+            {
+                fileCount++;
+            }
+        }
+    }
+    return fileCount;
+}
 
-                // Locate class 
-                if (std::regex_match(line, matchs, import_p, std::regex_constants::match_default))
-                {
-                    bool isPackage = matchs[1] == "package";
-                    if (isPackage)
-                    {
-                        packageName = std::string(matchs[2]);
-                        child_ptr = AddClass(packageName, sPackageTag, empty);
+// ---------------------------------------------------------------------------
+// --rev=<commit>, parse *.java blobs straight from the git object store.
+static const PatternList* sGitIgnorePatterns = NULL;
 
-                        file_ptr = AddClass(filename, sFileTag, packageName);
-                        child_ptr->add_interface(file_ptr);
-                    }
-                    else
-                    {
-                        lstring importName = std::string(matchs[2]);
-                        if (importName.find(packageName) == 0)
-                            continue;
-                        if (importName.find("com.wsi.") != 0)
-                            continue;
-                       
+static bool WantGitFile(const lstring& path)
+{
+    return hasExtension(path, ".java") && !FileMatches(lstring("/") + path, *sGitIgnorePatterns);
+}
+
+static void ParseGitFile(const lstring& path, const char* data, size_t length)
+{
+    MemoryStream in(data, length);
+    ParseJavaStream(in, path);
+}
+
+static size_t FindClassDefinitionsInGit(const lstring& dirname, const lstring& rev, const PatternList& ignorePatterns)
+{
+    GitReader git(dirname);
+    std::string prefix;
+    if (!git.run("rev-parse --show-prefix", prefix) || !git.open())
+    {
+        cerr << "Classtree: " << dirname << " is not a git work tree" << endl;
+        return 0;
+    }
+
+    // Limit scan to subdirectory when dirname is inside the work tree.
+    while (!prefix.empty() && (prefix.back() == '\n' || prefix.back() == '/'))
+        prefix.pop_back();
+
+    lstring treeName = rev + ":";
+    treeName += prefix;
+    sGitIgnorePatterns = &ignorePatterns;
+    return git.walkTree(treeName, prefix, WantGitFile, ParseGitFile);
+}
+
+// ---------------------------------------------------------------------------
+// Parse count sources on worker threads, loadSource(idx, path, data) fetches
+// each one. Declarations are added to clist in index order so output matches
+// a sequential scan. -I and -T modes share state and parse sequentially.
+template <typename LoadSource>
+static size_t ParseInParallel(size_t count, LoadSource loadSource)
+{
+    size_t fileCount = 0;
+    if (importPackage || tabularList)
+    {
+        lstring path;
+        std::string data;
+        for (size_t idx = 0; idx != count; idx++)
+        {
+            if (loadSource(idx, path, data))
+            {
+                MemoryStream in(data.data(), data.length());
+                if (ParseJavaStream(in, path))
+                    fileCount++;
+            }
+        }
+        return fileCount;
+    }
+
+    std::vector<lstring> paths(count);
+    std::vector<ClassDeclList> results(count);
+    std::vector<char> parsed(count, 0);
+    std::atomic<size_t> nextIdx(0);
+
+    auto worker = [&]()
+    {
+        std::string data;
+        size_t idx;
+        while ((idx = nextIdx++) < count)
+        {
+            if (loadSource(idx, paths[idx], data))
+                parsed[idx] = ParseSourceDecls(paths[idx], data, results[idx]);
+        }
+    };
+
+    size_t jobs = (parseJobs > 0) ? parseJobs : std::thread::hardware_concurrency();
+    jobs = max((size_t)1, min(jobs, count));
+    std::vector<std::thread> threads;
+    for (size_t job = 1; job < jobs; job++)
+        threads.push_back(std::thread(worker));
+    worker();
+    for (size_t job = 0; job != threads.size(); job++)
+        threads[job].join();
+
+    for (size_t idx = 0; idx != count; idx++)
+    {
+        AddClassDecls(paths[idx], results[idx]);
+        if (parsed[idx])
+            fileCount++;
+    }
+    return fileCount;
+}
+
+// ---------------------------------------------------------------------------
+// Java source held in memory, waiting to be parsed.
+struct SourceItem
+{
+    lstring path;
+    std::string data;
+};
+typedef std::vector<SourceItem> SourceList;
+
+static size_t ParseSourceList(SourceList& sources)
+{
+    return ParseInParallel(sources.size(), [&](size_t idx, lstring& path, std::string& data)
+    {
+        path = sources[idx].path;
+        data.swap(sources[idx].data);
+        return true;
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Zip/jar, central directory gives every member up front so workers
+// inflate and parse members directly from the mapped archive.
+static size_t FindClassDefinitionsInZip(const lstring& zipPath, const PatternList& ignorePatterns)
+{
+    ZipReader zip(zipPath);
+    if (!zip.open())
+    {
+        cerr << "Classtree: Unable to open " << zipPath << endl;
+        return 0;
+    }
+
+    std::vector<const ZipReader::Member*> members;
+    StringList memberPaths;
+    for (size_t idx = 0; idx != zip.members().size(); idx++)
+    {
+        const ZipReader::Member& member = zip.members()[idx];
+        lstring memberPath = zipPath + "!/";
+        memberPath += member.name;
+        if (WantSourceFile(memberPath) && !FileMatches(memberPath, ignorePatterns))
+        {
+            members.push_back(&member);
+            memberPaths.push_back(memberPath);
+        }
+    }
+
+    return ParseInParallel(members.size(), [&](size_t idx, lstring& path, std::string& data)
+    {
+        path = memberPaths[idx];
+        if (zip.read(*members[idx], data))
+            return true;
+        cerr << "Classtree: Unable to inflate " << path << endl;
+        return false;
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Tar/tar.gz is a sequential stream, members are read in batches and each
+// batch is parsed in parallel.
+static size_t FindClassDefinitionsInTar(const lstring& tarPath, const PatternList& ignorePatterns)
+{
+    static const size_t BATCH_BYTES = 32 << 20;
+
+    TarReader tar(tarPath);
+    if (!tar.open())
+    {
+        cerr << "Classtree: Unable to open " << tarPath << endl;
+        return 0;
+    }
+
+    size_t fileCount = 0;
+    size_t batchBytes = 0;
+    SourceList batch;
+    lstring name;
+    size_t size;
+    while (tar.next(name, size))
+    {
+        lstring memberPath = tarPath + "!/";
+        memberPath += name;
+        if (!WantSourceFile(memberPath) || FileMatches(memberPath, ignorePatterns))
+            continue;
+
+        batch.push_back(SourceItem());
+        batch.back().path = memberPath;
+        if (!tar.read(batch.back().data))
+        {
+            cerr << "Classtree: Truncated archive " << tarPath << endl;
+            batch.pop_back();
+            break;
+        }
+
+        batchBytes += size;
+        if (batchBytes >= BATCH_BYTES)
+        {
+            fileCount += ParseSourceList(batch);
+            batch.clear();
+            batchBytes = 0;
+        }
+    }
+
+    fileCount += ParseSourceList(batch);
+    return fileCount;
+}
+
+// ---------------------------------------------------------------------------
+static size_t FindClassDefinitionsInArchive(const lstring& path, const PatternList& ignorePatterns)
+{
+    if (IsZipArchive(path))
+        return FindClassDefinitionsInZip(path, ignorePatterns);
+    return FindClassDefinitionsInTar(path, ignorePatterns);
+}
+
+// ---------------------------------------------------------------------------
+// Read path list from stdin (-) or @listfile, one path per line or NUL
+// separated (find -print0, git ls-files -z).
+static bool ReadPathList(const lstring& listName, StringList& paths)
+{
+    std::string list;
+    if (listName == "-")
+    {
+        list.assign(std::istreambuf_iterator<char>(cin), std::istreambuf_iterator<char>());
+    }
+    else
+    {
+        ifstream in(listName.c_str() + 1, std::ios::binary);
+        if (!in.good())
+        {
+            cerr << "Classtree: Unable to open file list " << (listName.c_str() + 1) << endl;
+            return false;
+        }
+        list.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    char delim = (list.find('\0') != std::string::npos) ? '\0' : '\n';
+    size_t pos = 0;
+    while (pos < list.length())
+    {
+        size_t end = list.find(delim, pos);
+        if (end == std::string::npos)
+            end = list.length();
+        lstring path = list.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (delim == '\n' && !path.empty() && path.back() == '\r')
+            path.pop_back();
+        if (!path.empty())
+            paths.push_back(path);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// File list from stdin (-) or @listfile. Listed files are parsed as given,
+// no directory walk, archives in the list are opened and scanned.
+static size_t FindClassDefinitionsInList(const lstring& listName, const PatternList& ignorePatterns)
+{
+    StringList list;
+    if (!ReadPathList(listName, list))
+        return 0;
+
+    StringList paths;
+    StringList archives;
+    for (size_t idx = 0; idx != list.size(); idx++)
+    {
+        const lstring& path = list[idx];
+        lstring matchPath = path;
+        if (matchPath.find(SLASH_CHR) == lstring::npos)
+            matchPath.insert(0, 1, SLASH_CHR);
+        if (FileMatches(matchPath, ignorePatterns))
+            continue;
+        if (IsArchive(path))
+            archives.push_back(path);
+        else if (WantSourceFile(path))
+            paths.push_back(path);
+    }
+
+    size_t fileCount = ParseInParallel(paths.size(), [&](size_t idx, lstring& path, std::string& data)
+    {
+        path = paths[idx];
+        ifstream in(path, std::ios::binary);
+        if (!in.good())
+        {
+            cerr << "Classtree: Unable to open " << path << endl;
+            return false;
+        }
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return true;
+    });
+
+    for (size_t idx = 0; idx != archives.size(); idx++)
+        fileCount += FindClassDefinitionsInArchive(archives[idx], ignorePatterns);
+    return fileCount;
+}
+
+// ---------------------------------------------------------------------------
+// Shard file holds one partial scan, declarations grouped by source file so
+// a merge streams each group straight back through AddClassDecls. Parents
+// declared in another shard stay _no_file_ until that shard is merged.
+//
+//  javatree-shard<tab>1
+//  F<tab>source path
+//  C<tab>name<tab>modifier<tab>filename
+//  P<tab>parent
+//  I<tab>interface
+//
+static const char sShardMagic[] = "javatree-shard\t1";
+
+static void WriteShardLinks(ostream& out, char tag, const ClassLinkage& links)
+{
+    for (const ClassLinkage* link_ptr = &links; link_ptr != NULL; link_ptr = link_ptr->linkage)
+    {
+        if (link_ptr->relations != NULL)
+            out << tag << '\t' << link_ptr->relations->name() << '\n';
+    }
+}
+
+static bool WriteShard(const lstring& shardPath)
+{
+    ofstream out(shardPath, std::ios::binary);
+    if (!out.good())
+    {
+        cerr << "Classtree: Unable to create " << shardPath << endl;
+        return false;
+    }
+
+    out << sShardMagic << '\n';
+    for (FileClassList::const_iterator fileIter = fileClasses.begin(); fileIter != fileClasses.end(); fileIter++)
+    {
+        out << "F\t" << fileIter->first << '\n';
+        const StringList& names = fileIter->second;
+        for (size_t idx = 0; idx != names.size(); idx++)
+        {
+            ClassList::const_iterator iter = clist.find(names[idx]);
+            if (iter == clist.end())
+                continue;
+            const ClassRelations* crel_ptr = iter->second;
+            out << "C\t" << crel_ptr->name() << '\t' << crel_ptr->modifier() << '\t' << crel_ptr->file() << '\n';
+            WriteShardLinks(out, 'P', crel_ptr->parents());
+            WriteShardLinks(out, 'I', crel_ptr->interfaces());
+        }
+    }
+    return out.good();
+}
+
+// ---------------------------------------------------------------------------
+// Merge one shard into clist, return count of source files it holds.
+static size_t MergeShard(const lstring& shardPath)
+{
+    ifstream in(shardPath, std::ios::binary);
+    lstring line;
+    if (!getline(in, line) || line != sShardMagic)
+    {
+        cerr << "Classtree: Not a shard file " << shardPath << endl;
+        return 0;
+    }
+
+    size_t fileCount = 0;
+    lstring filepath;
+    ClassDeclList decls;
+    while (getline(in, line))
+    {
+        if (line.length() < 2 || line[1] != '\t')
+            continue;
+        lstring value = line.substr(2);
+        switch (line[0])
+        {
+        case 'F':
+            if (!filepath.empty())
+                AddClassDecls(filepath, decls);
+            filepath = value;
+            decls.clear();
+            fileCount++;
+            break;
+        case 'C':
+            {
+                size_t tab1 = value.find('\t');
+                size_t tab2 = (tab1 == lstring::npos) ? tab1 : value.find('\t', tab1 + 1);
+                if (tab2 == lstring::npos)
+                    break;
+                decls.push_back(ClassDecl());
+                decls.back().name = value.substr(0, tab1);
+                decls.back().modifier = value.substr(tab1 + 1, tab2 - tab1 - 1);
+                decls.back().filename = value.substr(tab2 + 1);
+            }
+            break;
+        case 'P':
+            if (!decls.empty())
+                decls.back().parents.push_back(value);
+            break;
+        case 'I':
+            if (!decls.empty())
+                decls.back().interfaces.push_back(value);
+            break;
+        }
+    }
+    if (!filepath.empty())
+        AddClassDecls(filepath, decls);
+    return fileCount;
+}
+
+// ---------------------------------------------------------------------------
+// --subtype=Sub,Super or --subtype=@file with one "Sub Super" pair per line.
+// Sub ending in * checks every class with that prefix. Prints one
+// "Sub<tab>Super<tab>true|false" line per check, return count of false.
+StringList subtypeQueries;
+
+static size_t SubtypeCheck(const SubtypeIndex& index, const lstring& subName, const lstring& superName)
+{
+    size_t failed = 0;
+    unsigned superId = index.id(superName);
+    if (superId == SubtypeIndex::NOT_FOUND)
+        cerr << "Classtree: Unknown class " << superName << endl;
+
+    if (!subName.empty() && subName.back() == '*')
+    {
+        lstring prefix = subName.substr(0, subName.length() - 1);
+        for (unsigned subId = 0; subId != index.size(); subId++)
+        {
+            if (index.name(subId).compare(0, prefix.length(), prefix) != 0)
+                continue;
+            bool isSub = index.isSubtype(subId, superId);
+            cout << index.name(subId) << "\t" << superName << "\t" << (isSub ? "true" : "false") << "\n";
+            if (!isSub)
+                failed++;
+        }
+        return failed;
+    }
+
+    unsigned subId = index.id(subName);
+    if (subId == SubtypeIndex::NOT_FOUND)
+        cerr << "Classtree: Unknown class " << subName << endl;
+    bool isSub = index.isSubtype(subId, superId);
+    cout << subName << "\t" << superName << "\t" << (isSub ? "true" : "false") << "\n";
+    return isSub ? 0 : 1;
+}
+
+static size_t SubtypeQueries()
+{
+    SubtypeIndex index;
+    index.build(clist);
+
+    size_t failed = 0;
+    for (size_t idx = 0; idx != subtypeQueries.size(); idx++)
+    {
+        const lstring& query = subtypeQueries[idx];
+        if (query.empty() || query[0] != '@')
+        {
+            size_t comma = query.find(',');
+            if (comma == lstring::npos)
+                cerr << "Classtree: Expected --subtype=Sub,Super not " << query << endl;
+            else
+                failed += SubtypeCheck(index, query.substr(0, comma), query.substr(comma + 1));
+            continue;
+        }
+
+        ifstream in(query.c_str() + 1);
+        if (!in.good())
+        {
+            cerr << "Classtree: Unable to open " << (query.c_str() + 1) << endl;
+            continue;
+        }
+        lstring line;
+        while (getline(in, line))
+        {
+            Split split(line, " \t,", FindSplit);
+            if (split.size() >= 2)
+                failed += SubtypeCheck(index, split[0], split[1]);
+        }
+    }
+    return failed;
+}
+
+// ---------------------------------------------------------------------------
+// Inheritance depth of class, 1 for root classes.
+typedef std::map<const ClassRelations*, size_t> DepthMap;
+
+static size_t ClassDepth(const ClassRelations* crel_ptr, DepthMap& depthMap)
+{
+    DepthMap::const_iterator iter = depthMap.find(crel_ptr);
+    if (iter != depthMap.end())
+        return iter->second;
+
+    depthMap[crel_ptr] = 1;     // stop on cyclic extends
+    size_t depth = 0;
+    for (const ClassLinkage* link_ptr = &crel_ptr->parents(); link_ptr != NULL; link_ptr = link_ptr->linkage)
+    {
+        if (link_ptr->relations != NULL)
+            depth = max(depth, ClassDepth(link_ptr->relations, depthMap));
+    }
+
+    depthMap[crel_ptr] = depth + 1;
+    return depth + 1;
+}
+
+// ---------------------------------------------------------------------------
+// Class graph metrics, classes, max depth, max and average fan-out.
+static lstring HistoryMetrics()
+{
+    DepthMap depthMap;
+    size_t maxDepth = 0;
+    size_t maxFanOut = 0;
+    size_t parentCnt = 0;
+    size_t childCnt = 0;
+
+    ClassList::const_iterator iter;
+    for (iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        const ClassRelations* crel_ptr = iter->second;
+        maxDepth = max(maxDepth, ClassDepth(crel_ptr, depthMap));
+
+        size_t fanOut = 0;
+        for (const ClassLinkage* link_ptr = &crel_ptr->children(); link_ptr != NULL; link_ptr = link_ptr->linkage)
+        {
+            if (link_ptr->relations != NULL)
+                fanOut++;
+        }
+        if (fanOut != 0)
+        {
+            parentCnt++;
+            childCnt += fanOut;
+            maxFanOut = max(maxFanOut, fanOut);
+        }
+    }
+
+    std::ostringstream metrics;
+    metrics << clist.size() << "\t" << maxDepth << "\t" << maxFanOut
+        << "\t" << std::fixed << std::setprecision(2) << (parentCnt ? (double)childCnt / parentCnt : 0.0);
+    return metrics.str().c_str();
+}
+
+// ---------------------------------------------------------------------------
+// Output one row of class graph metrics.
+static void outHistoryMetrics(const lstring& commit, size_t fileCnt)
+{
+    cout << commit << "\t" << HistoryMetrics() << "\t" << fileCnt << std::endl;
+}
+
+// ---------------------------------------------------------------------------
+// --history=<from>..<to>, full parse at <from> then for each first-parent
+// commit re-parse only the files 'git diff-tree' reports as changed.
+static size_t HistoryOfClasses(const lstring& dirname, const lstring& range, const PatternList& ignorePatterns)
+{
+    size_t dotPos = range.find("..");
+    if (dotPos == lstring::npos || dotPos == 0)
+    {
+        cerr << "Classtree: --history needs <from>..<to> range" << endl;
+        return 0;
+    }
+    lstring fromRev = range.substr(0, dotPos);
+
+    GitReader git(dirname);
+    std::string prefix;
+    if (!git.run("rev-parse --show-prefix", prefix) || !git.open())
+    {
+        cerr << "Classtree: " << dirname << " is not a git work tree" << endl;
+        return 0;
+    }
+    while (!prefix.empty() && (prefix.back() == '\n' || prefix.back() == '/'))
+        prefix.pop_back();
+
+    sGitIgnorePatterns = &ignorePatterns;
+    lstring treeName = fromRev + ":";
+    treeName += prefix;
+    size_t fileCnt = git.walkTree(treeName, prefix, WantGitFile, ParseGitFile);
+
+    cout << "Commit\tClasses\tMaxDepth\tMaxFanOut\tAvgFanOut\tFilesParsed\n";
+    outHistoryMetrics(fromRev, fileCnt);
+
+    // Single diff-tree process, --always emits a commit line even when
+    // nothing under prefix changed.
+    lstring cmd = "rev-list --reverse --first-parent --parents ";
+    cmd += GitReader::quote(range);
+    cmd += " | git -C ";
+    cmd += GitReader::quote(dirname.empty() ? lstring(".") : dirname);
+    cmd += " -c core.quotePath=false diff-tree --stdin --always -r --name-status --no-renames";
+    if (!prefix.empty())
+    {
+        // prefix is relative to the repo top, not to -C dirname.
+        cmd += " -- ";
+        cmd += GitReader::quote(":/" + prefix);
+    }
 
-#if 0
-                        child_ptr = AddClass(packageName, empty, filename);
-                        add_parent(child_ptr, importName, filename);
-#else
-                        child_ptr = AddClass(importName, packageName, filename);
-                        add_parent(child_ptr, packageName, filename);
-                        file_ptr->add_child(child_ptr);
-#endif
-                        // crel_ptr->add_interface(new ClassRelations(token, interface, "_no_file_"));
-                    }
-                }
-            }
+    FILE* pipe = git.command(cmd);
+    if (pipe == NULL)
+        return fileCnt;
+
+    size_t totalCnt = fileCnt;
+    lstring commit;
+    std::string blob;
+    lstring type;
+    char buffer[PATH_MAX + 16];
+    fileCnt = 0;
+    while (fgets(buffer, sizeof(buffer), pipe) != NULL)
+    {
+        lstring line = buffer;
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+            line.resize(line.length() - 1);
 
-            in.close();
-            return true;
+        size_t tabPos = line.find('\t');
+        if (tabPos == lstring::npos)
+        {
+            if (!commit.empty())
+                outHistoryMetrics(commit, fileCnt);
+            commit = line.substr(0, line.find(' '));
+            fileCnt = 0;
+            continue;
         }
-        else
+
+        lstring path = line.substr(tabPos + 1);
+        if (!WantGitFile(path))
+            continue;
+
+        RemoveFileClasses(path);
+        lstring objName = commit + ":";
+        objName += path;
+        if (line[0] != 'D' && git.getObject(objName, type, blob))
         {
-            cerr << "Classtree: Unable to open " << filepath << endl;
+            ParseGitFile(path, blob.data(), blob.length());
+            fileCnt++;
+            totalCnt++;
         }
     }
-    catch (exception ex)
+    pclose(pipe);
+
+    if (!commit.empty())
     {
-        cerr << "Parsing error in file:" << filepath << endl;
-        cerr << ex.what() << std::endl;
+        outHistoryMetrics(commit, fileCnt);
+
+#ifdef DEBUG
+        // Patched graph of the last commit must match a full parse of it.
+        lstring patched = HistoryMetrics();
+        Release_clist();
+        treeName = commit + ":";
+        treeName += prefix;
+        git.walkTree(treeName, prefix, WantGitFile, ParseGitFile);
+        if (HistoryMetrics() != patched)
+            cerr << "Classtree: --history " << commit << " differs from full parse, "
+                << patched << " != " << HistoryMetrics() << endl;
+#endif
     }
-    return false;
+    return totalCnt;
 }
 
 // ---------------------------------------------------------------------------
-// Return true if inPath (filename part) matches pattern in patternList
-bool FileMatches(const lstring& inPath, const PatternList& patternList)
+// --impact, classes declared in the changed files and every class that
+// extends or implements one of them, with their files.
+static bool ImpactOfChanges(const lstring& changedFiles)
 {
-    size_t nameStart = inPath.rfind(SLASH_CHR) + 1;
-    if (patternList.empty() || nameStart == 0 || nameStart == inPath.length())
-        return false;
+    StringList changed;
+    if (changedFiles == "-" || changedFiles[0] == '@')
+    {
+        if (!ReadPathList(changedFiles, changed))
+            return false;
+    }
+    else
+    {
+        Split paths(changedFiles, ",", FindSplit);
+        changed.assign(paths.begin(), paths.end());
+    }
 
-    for (size_t idx = 0; idx != patternList.size(); idx++)
-        if (std::regex_match(inPath.begin() + nameStart, inPath.end(), patternList[idx]))
-            return true;
+    std::string image;
+    GraphSnapshot::build(image, clist, fileClasses);
+    GraphSnapshot graph;
+    graph.open(image);
+
+    ChangeImpact impact;
+    impact.build(graph);
+    ChangeImpact::AffectedList affected;
+    size_t matched = impact.affected(changed, affected);
+    impact.writeText(affected, cout);
+    cerr << matched << " of " << changed.size() << " files matched, "
+        << affected.size() << " classes affected\n";
+    return true;
+}
 
-    return false;
+// ---------------------------------------------------------------------------
+// --diff, compare snapshot with a second snapshot or the scanned classes.
+static bool DiffGraphs(const lstring& diffPaths)
+{
+    Split paths(diffPaths, ",", FindSplit);
+    GraphSnapshot oldGraph;
+    GraphSnapshot newGraph;
+    if (paths.empty() || !oldGraph.open(paths[0]) || (paths.size() > 1 && !newGraph.open(paths[1])))
+    {
+        cerr << "Classtree: Unable to open graph snapshot " << diffPaths << endl;
+        return false;
+    }
+    if (paths.size() == 1)
+    {
+        std::string image;
+        GraphSnapshot::build(image, clist, fileClasses);
+        newGraph.open(image);
+    }
+
+    GraphDiff diff;
+    diff.compare(oldGraph, newGraph);
+    if (cset == VIZ_CHAR)
+    {
+        outVizHeader();
+        diff.writeViz(cout);
+        outVizTrailer();
+    }
+    else
+    {
+        diff.writeText(cout);
+    }
+    return true;
 }
 
 // ---------------------------------------------------------------------------
-static size_t FindClassDefinitions(const lstring& dirname, PatternList ignorePatterns)
+// Read classes from one input path, dispatch by kind of path.
+static size_t ScanPath(const lstring& path, const PatternList& ignorePatterns)
 {
-    Directory_files directory(dirname);
-    lstring fullname;
+    if (mergeShards)
+        return MergeShard(path);
+    else if (!gitHistory.empty())
+        return HistoryOfClasses(path, gitHistory, ignorePatterns);
+    else if (!gitRev.empty())
+        return FindClassDefinitionsInGit(path, gitRev, ignorePatterns);
+    else if (path == "-" || path[0] == '@')
+        return FindClassDefinitionsInList(path, ignorePatterns);
+    else if (IsArchive(path))
+        return FindClassDefinitionsInArchive(path, ignorePatterns);
+    else if (IsCompiledFile(path))
+        return (WantSourceFile(path) && ParseCompiledFile(path)) ? 1 : 0;
+    return FindClassDefinitions(path, ignorePatterns);
+}
 
-    size_t fileCount = 0;
-    while (directory.more())
+// ---------------------------------------------------------------------------
+static void LoadGraph(const lstring& snapshotPath)
+{
+    GraphSnapshot snapshot;
+    if (snapshot.open(snapshotPath))
     {
-        directory.fullName(fullname);
-        if (directory.is_directory())
-        {
-            fileCount += FindClassDefinitions(fullname, ignorePatterns);
-        }
-        else if (fullname.length() > 0 && !FileMatches(fullname, ignorePatterns))
-        {
-            if (importPackage)
-            {
-                if (FindImportPackageInFile(fullname))
-                    fileCount++;
-            }
-            else if (tabularList)
-            {
-                if (TabularListOfInFile(fullname))
-                    fileCount++;
-            }
-            else
-            {
-                if (FindClassDefsInFile(fullname))
-                    fileCount++;
-            }
-        }
+        snapshot.load(clist, fileClasses);
+        std::cerr << snapshot.classCount() << " classes loaded\n";
     }
-    return fileCount;
+}
+
+// ---------------------------------------------------------------------------
+// Inputs in command line order, a --serve rescan request repeats them
+// and --watch watches the directories among them.
+struct ServeScan
+{
+    lstring path;
+    bool snapshot;              // --load-graph file
+    PatternList ignorePatterns;
+};
+static std::vector<ServeScan> serveScans;
+
+static void AddServeScan(const lstring& path, bool snapshot, const PatternList& ignorePatterns)
+{
+    ServeScan scan = { path, snapshot, ignorePatterns };
+    serveScans.push_back(scan);
 }
 
 // ---------------------------------------------------------------------------
@@ -1446,6 +3104,25 @@ void outputHtmlTableStyle()
         "</script> \n";
 }
 
+// ---------------------------------------------------------------------------
+// -h tree connectors, each nested <li> draws its own elbow and the line
+// down to its next sibling.
+void outputHtmlTreeStyle()
+{
+    cout <<
+        "<style>\n"
+        "ul.jt, ul.jt ul { list-style: none; margin: 0; padding: 0; }\n"
+        "ul.jt { font: 12px Verdana, Arial, sans-serif; }\n"
+        "ul.jt ul { margin-left: 6px; }\n"
+        "ul.jt li { position: relative; padding-left: 14px; line-height: 18px; white-space: nowrap; }\n"
+        "ul.jt ul > li { border-left: 1px solid #999; }\n"
+        "ul.jt ul > li:last-child { border-left: none; }\n"
+        "ul.jt ul > li:before { content: ''; position: absolute; left: 0; top: 0; width: 10px; height: 9px; border-bottom: 1px solid #999; }\n"
+        "ul.jt ul > li:last-child:before { border-left: 1px solid #999; }\n"
+        "ul.jt i { color: #999; font-size: 11px; }\n"
+        "</style>\n";
+}
+
 // ---------------------------------------------------------------------------
 void outputHtmlTitle3(const char* title)
 {
@@ -1453,13 +3130,317 @@ void outputHtmlTitle3(const char* title)
 }
 
 // ---------------------------------------------------------------------------
+// Class tree report in the active format (-z, -j or text), clist is kept.
+static void OutputClassTree()
+{
+    SortChildren();
+    sNodeNum = 1;
+    needHeader = true;
+    outStream.clear();
+    if (cset == VIZ_CHAR)
+    {
+        display_dependences();
+    }
+    else if (cset == SVG_CHAR)
+    {
+        SvgTree svgTree;
+        svgTree.build(clist);
+        svgTree.write(cout, graphName);
+    }
+    else if (cset == JAVA_CHAR)
+    {
+        outputHtmlPrefix1();
+        outputHtmlMetaHeader2();
+        outputHtmlTitle3(graphName);
+#if 1
+        cout <<
+            "	<link rel=StyleSheet href=dtree/dtree.css type=text/css /> \n"
+            "	<script type=text/javascript src=dtree/dtree.js></script>  \n";
+#else
+        cout << "<style>\n" << dtree_css << "\n</style>\n";
+        cout << "<script type=\"text/javascript\">\n" << dtree_js << "\n</script>\n";
+#endif
+         cout <<
+            "</head>           \n"
+            "<body>            \n"
+            "<h2>Example</h2>  \n"
+            "<div class=dtree> \n"
+            "	<p><a href=javascript:d.openAll();>open all</a> | <a href=javascript:d.closeAll();>close all</a></p>  \n"
+            "	<script type=text/javascript> \n"
+            "		<!--                \n"
+            "		d = new dTree('d'); \n"
+                    "       d.add(0, -1, '" << graphName << "');\n";
+
+        display_dependences();
+
+        cout << 
+            "		document.write(d); \n"
+            "       d.openAll();\n"
+            "		//--> \n"
+            "	</script> \n"
+            "</div>  \n"
+            "</body> \n"
+            "</html> \n"
+            "\n";
+    }
+    else if (cset == HTML_CHAR)
+    {
+        outputHtmlPrefix1();
+        outputHtmlTreeStyle();
+        outputHtmlTitle3(graphName);
+        cout << "</head>\n<body>\n";
+        if (show_names)
+        {
+            std::ostringstream names;
+            SwapStream swapStream(cout);
+            swapStream.swap(names);
+            display_names();
+            swapStream.restore();
+            cout << "<pre>\n";
+            cout.flush();
+            html_fputs(names.str().c_str());
+            fputs("</pre>\n", stdout);
+        }
+        cout.flush();
+        if (show_tree)
+            display_html_tree();
+        fputs("</body>\n</html>\n", stdout);
+    }
+    else
+    {
+        fputs(doc_begin[cset], stdout);
+                    
+        if (show_names) 
+            display_names();
+        if (show_tree)  
+            display_dependences();
+        
+        fputs(doc_end[cset], stdout);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Replace report file with class tree, written aside then renamed so a
+// viewer never sees a partial file.
+static bool WriteReport(const lstring& reportPath)
+{
+#ifdef HAVE_WIN
+    return false;
+#else
+    lstring tmpPath = reportPath + ".tmp";
+    cout.flush();
+    fflush(stdout);
+    int savedFd = dup(1);
+    if (savedFd < 0 || freopen(tmpPath, "w", stdout) == NULL)
+    {
+        cerr << "Classtree: Unable to write " << tmpPath << endl;
+        if (savedFd >= 0)
+            close(savedFd);
+        return false;
+    }
+
+    OutputClassTree();
+    cout.flush();
+    fflush(stdout);
+    dup2(savedFd, 1);
+    close(savedFd);
+    return rename(tmpPath, reportPath) == 0;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Replace clist with its package view, --packages.
+static void AggregatePackages()
+{
+    ClassList packages;
+    packageGraph = PackageGraph(packageDepth);
+    packageGraph.build(clist, packages);
+    Release_clist();
+    clist.swap(packages);
+    vizGraph.weights(&packageGraph.weights());
+
+    std::cerr << clist.size() << " packages";
+    if (!packageGraph.rootLinks().empty())
+        std::cerr << ", " << packageGraph.rootLinks().size() << " links close package cycles";
+    std::cerr << "\n";
+}
+
+// ---------------------------------------------------------------------------
+// --watch, patch clist as files change instead of rescanning.
+struct WatchRoot
+{
+    lstring dirPath;                        // real path, as scan recorded files
+    const PatternList* ignorePatterns;
+};
+static std::vector<WatchRoot> watchRoots;
+static SourceWatcher::PathList changedFiles;
+
+static const PatternList* WatchIgnorePatterns(const lstring& path)
+{
+    for (size_t idx = 0; idx != watchRoots.size(); idx++)
+    {
+        const lstring& dirPath = watchRoots[idx].dirPath;
+        if (path.compare(0, dirPath.length(), dirPath) == 0 && path[dirPath.length()] == SLASH_CHR)
+            return watchRoots[idx].ignorePatterns;
+    }
+    return NULL;
+}
+
+// Retract declarations of changed files, or of every file below a removed
+// directory, then reparse the files still present.
+static size_t PatchChangedFiles(const SourceWatcher::PathList& changed)
+{
+    StringList parsePaths;
+    for (size_t idx = 0; idx != changed.size(); idx++)
+    {
+        const lstring& path = changed[idx];
+        RemoveFileClasses(path);
+
+        lstring prefix = path;
+        prefix += SLASH_CHR;
+        FileClassList::const_iterator iter = fileClasses.lower_bound(prefix);
+        StringList below;
+        for (; iter != fileClasses.end() && iter->first.compare(0, prefix.length(), prefix) == 0; iter++)
+            below.push_back(iter->first);
+        for (size_t bIdx = 0; bIdx != below.size(); bIdx++)
+            RemoveFileClasses(below[bIdx]);
+
+        const PatternList* ignorePatterns = WatchIgnorePatterns(path);
+        if (ignorePatterns != NULL && WantSourceFile(path) && !FileMatches(path, *ignorePatterns))
+            parsePaths.push_back(path);
+    }
+
+    return ParseInParallel(parsePaths.size(), [&](size_t idx, lstring& path, std::string& data)
+    {
+        path = parsePaths[idx];
+        MappedFile map;
+        if (!map.open(path))
+            return false;   // deleted
+        data.assign(map.data(), map.length());
+        return true;
+    });
+}
+
+// Called through GraphServer::update with the writer lock held, or
+// directly when not serving.
+static bool PatchGraph(std::string& image)
+{
+    PatchChangedFiles(changedFiles);
+    if (resolveNames)
+        RelinkFileDecls();
+    if (!watchReport.empty())
+        WriteReport(watchReport);
+    if (!servePath.empty())
+        GraphSnapshot::build(image, clist, fileClasses);
+    return true;
+}
+
+// Called by GraphServer, one rescan at a time. Queries keep reading the
+// published snapshot so the class list is free to rebuild here.
+static bool RescanGraph(std::string& image)
+{
+    if (serveScans.empty())
+        return false;
+    Release_clist();
+    for (size_t idx = 0; idx != serveScans.size(); idx++)
+    {
+        if (serveScans[idx].snapshot)
+            LoadGraph(serveScans[idx].path);
+        else if (serveScans[idx].path == "-")
+            cerr << "Classtree: stdin list not rescanned\n";
+        else
+            ScanPath(serveScans[idx].path, serveScans[idx].ignorePatterns);
+    }
+    if (resolveNames)
+        ResolveClassDecls();
+    if (!focusClasses.empty())
+        FocusClassList();
+    if (packageDepth >= 0)
+        AggregatePackages();
+
+    if (!watchReport.empty())
+        WriteReport(watchReport);
+
+    GraphSnapshot::build(image, clist, fileClasses);
+    if (!watchSources)
+        Release_clist();
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Watch scanned directories, patch the class graph on each change and
+// refresh the report file and/or the --serve graph. Runs until a server
+// shutdown request, or until interrupted when not serving.
+static bool WatchSources()
+{
+    SourceWatcher watcher;
+    if (!watcher.open())
+        return false;
+
+    for (size_t idx = 0; idx != serveScans.size(); idx++)
+    {
+        const ServeScan& scan = serveScans[idx];
+        WatchRoot root = { "", &scan.ignorePatterns };
+        size_t dirCount = scan.snapshot ? 0 : watcher.add(scan.path, root.dirPath);
+        if (dirCount == 0)
+        {
+            cerr << "Classtree: --watch skips " << scan.path << ", not a directory\n";
+            continue;
+        }
+        watchRoots.push_back(root);
+        cerr << "Watching " << dirCount << " directories in " << scan.path << endl;
+    }
+    if (watchRoots.empty())
+        return false;
+
+    std::string image;
+    if (!watchReport.empty())
+        WriteReport(watchReport);
+
+    std::unique_ptr<GraphServer> server;
+    std::atomic<bool> watching(true);
+    auto watchLoop = [&]()
+    {
+        while (watching)
+        {
+            if (!watcher.wait(changedFiles, 200))
+                continue;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (server)
+                server->update(PatchGraph);
+            else
+                PatchGraph(image);
+            long ms = (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            cerr << changedFiles.size() << " files changed, " << clist.size() << " classes, " << ms << " ms\n";
+        }
+    };
+
+    if (servePath.empty())
+    {
+        watchLoop();
+        return true;
+    }
+
+    GraphSnapshot::build(image, clist, fileClasses);
+    server.reset(new GraphServer(servePath, RescanGraph));
+    server->publish(image);
+    std::thread watchThread(watchLoop);
+    bool served = server->run();
+    watching = false;
+    watchThread.join();
+    return served;
+}
+
 int main(int argc, char* argv[])
 {  
+    int exitCode = 0;
     if (argc == 1)
     {
         cerr << "\n" << argv[0] << " (" << version << ")\n"
             << "\nDes: Generate Java class dependence tree (" __DATE__ ")"
-            "\nUse: Javatree [-+ntgxshjz] header_files...\n"
+            "\nUse: Javatree [-+ntgxshjzv] header_files|dir|zip|jar|apk|dex|tar.gz|@list|-...\n"
             "\nSwitches (*=default)(-=off, +=on):"
             "\n  n  ; Show alphabetic class name list"
             "\n* t  ; Show class dependency tree"
@@ -1468,37 +3449,98 @@ int main(int argc, char* argv[])
             "\n* g  ; Use graphics for tree connections"
             "\n  x  ; Use (+|-) for tree connections"
             "\n  s  ; Use spaces for tree connections"
-            "\n  h  ; Html tree connections (needs images 0.png, 1.png, 2.png, n.png)"
+            "\n  h  ; Html tree, nested lists with css connectors"
             "\n  j  ; Java tree connections (needs dtree www.destroydrop.com/javascript/tree/)"
             "\n  z  ; GraphViz (see https://graphviz.gitlab.io/)"
+            "\n  v  ; Svg tree, built-in layout, no GraphViz needed"
             "\n"
             "\nModifiers:"
-            "\n  Z              ; Split GraphViz by tree, use with -O"
+            "\n  Z              ; Split GraphViz by tree, use with -O, unchanged files kept"
             "\n  N=nodesPerFile ; Split by nodes per file, use with -O"
             "\n  O=outpath      ; Save output in file"
             "\n  T=tabular      ; Tabular html "
+            "\n  I=imports      ; Package import graph and cycles"
             "\n  V=filePattern  ; Ignore files"
             "\n  A=allClasses   ; Defaults to public"
             "\n  F=full path    ; Defaults to relative"
+            "\n  --rev=commit   ; Read java files from git commit, no checkout"
+            "\n  --history=from..to ; Class count, depth and fan-out per git commit"
+            "\n  --jobs=N       ; Parser threads for archives, defaults to cpu count"
+            "\n  --import-prefix=a.b,c.d ; -I keeps imports of these packages, defaults to all"
+            "\n  --resolve      ; Package qualified class names, extends/implements resolved by imports"
+            "\n  --focus=class[,depth] ; Only classes linked to class, repeat for more"
+            "\n  --focus-dir=up|down|both ; Follow parents, children or both (default)"
+            "\n  --subtype=Sub,Super ; Check Sub extends/implements Super, Sub may end in *"
+            "\n  --subtype=@file ; Check each 'Sub Super' line of file, exit 1 if any fail"
+            "\n  --shard-out=file ; Save partial class graph, no other output"
+            "\n  --merge        ; Inputs are shard files, merge then output"
+            "\n  --save-graph=file ; Save binary class graph snapshot, no other output"
+            "\n  --load-graph=file ; Load class graph snapshot instead of parsing"
+            "\n  --diff=old[,new] ; Added, removed, re-parented classes since snapshot old, -z for GraphViz"
+            "\n  --impact=a.java,b.java ; Classes declared in files or extending them, or @list or -"
+            "\n  --serve=socket ; Keep graph resident, answer queries on unix socket"
+            "\n  --watch[=report] ; Reparse changed files, rewrite report and/or --serve graph"
+            "\n  --packages[=depth] ; Package view, classes collapsed into packages, depth limits segments, implies --resolve"
+            "\n  --lazy-tree=dir ; Html tree in dir, subtrees load on expand, for very large trees"
+            "\n  --table-dir=dir ; Paged -T table in dir, rows in JSON chunks, sortable and searchable"
+            "\n  --render=svg|png ; Run dot on -z -O files in parallel, unchanged files are skipped"
+            "\n  --parallel-emit ; Text tree subtrees written by --jobs threads, output must be a file"
             "\n"
             "\nExamples (assumes java source code in directory src):"
             "\n  javatree -t +n  src\\*.java  ; *.java prevent recursion"
             "\n  javatree -x  src > javaTree.txt"
             "\n  javatree -h  src > javaTree.html"
             "\n  javatree -h -T src > javaTable.html"
+            "\n  javatree --table-dir=classTable src  ; open classTable/index.html"
             "\n  javatree -j  src > javaTreeWithJs.html"
+            "\n  javatree -v  src > javaTree.svg"
+            "\n  javatree -x --parallel-emit src > javaTree.txt"
+            "\n  javatree --lazy-tree=classTree src  ; open classTree/index.html"
+            "\n  javatree -x --rev=v1.2 src > javaTree-v1.2.txt"
+            "\n  javatree --history=v1.2..v1.3 src > classHistory.txt"
+            "\n  javatree -x src.zip lib-sources.jar src.tar.gz > javaTree.txt"
+            "\n  javatree -x classes lib.jar > javaTree.txt  ; compiled .class files"
+            "\n  javatree -x app.apk classes2.dex > javaTree.txt  ; android dex class_defs"
+            "\n  git ls-files -z '*.java' | javatree -x - > javaTree.txt  ; file list from stdin"
+            "\n  javatree -x @module.lst > javaTree.txt  ; file list, one path per line"
+            "\n  javatree --shard-out=part1.jts @part1.lst  ; one shard per build agent"
+            "\n  javatree -x --merge part1.jts part2.jts > javaTree.txt"
+            "\n  javatree --save-graph=app.jtg src ; javatree -x --load-graph=app.jtg"
+            "\n  javatree --rev=v1.2 --save-graph=v1.2.jtg src ; javatree -z --rev=v1.3 --diff=v1.2.jtg src"
+            "\n  javatree -I --import-prefix=com.wsi src > packageImports.txt"
+            "\n  javatree -z --focus=BaseFragment --focus-dir=down src > baseFragment.dot"
+            "\n  javatree -z --packages=3 src > packages.dot  ; com.wsi.ui, edges weighted by class links"
+            "\n  javatree --resolve --subtype=com.app.ui.*,android.app.Fragment src"
+            "\n  javatree --serve=/tmp/jt.sock src &  echo 'subtree BaseFragment' | nc -U /tmp/jt.sock"
+            "\n  javatree -z --watch=classes.dot src  ; updated on every save"
+            "\n  git diff --name-only main | javatree --load-graph=app.jtg --impact=- | cut -f3 | sort -u"
             "\n"
             "\n  -V is case sensitive "
             "\n  javatree -z -Z -O=.\\viz\\ -V=*Test* -V=*Exception* src >directgraph.dot"
             "\n  javatree -z -N=10 -O=.\\viz\\ -V=*Test* -V=*Exception* src >directgraph.dot"
+            "\n  javatree -z -Z -O=viz/ --render=svg --jobs=8 src >directgraph.dot"
             "\n";
     }
     else
     {
+        // Options that change how inputs are scanned, inputs may come first.
+        for (int argn = 1; argn < argc; argn++)
+        {
+            if (strncmp(argv[argn], "--history=", 10) == 0
+                || strcmp(argv[argn], "--watch") == 0 || strncmp(argv[argn], "--watch=", 8) == 0)
+                keepFileDecls = true;
+            else if (strncmp(argv[argn], "--table-dir=", 12) == 0)
+            {
+                tabularList = true;
+                tableDir = argv[argn] + 12;
+                tableWriter.open(tableDir);
+            }
+        }
+
         PatternList ignorePatterns;
         for (int argn = 1; argn < argc; argn++)
         {
-            if (*argv[argn] == '-' || *argv[argn] == '+')
+            if ((*argv[argn] == '-' || *argv[argn] == '+') && argv[argn][1] != '\0')
             {
                 bool polarity = (*argv[argn] == '+');
                 
@@ -1515,6 +3557,7 @@ int main(int argc, char* argv[])
                     case 'h': cset      = HTML_CHAR;      break;
                     case 'j': cset      = JAVA_CHAR;      break;
                     case 'z': cset      = VIZ_CHAR;       break;
+                    case 'v': cset      = SVG_CHAR;       break;
 
                     // Modifiers
                     case 'A': allClasses = true;          break;
@@ -1525,6 +3568,76 @@ int main(int argc, char* argv[])
                     case 'N':
                         nodesPerFile = (int)strtol(argv[argn] + 3, 0, 10);
                         break;
+                    case '-':   // --name=value
+                        if (strncmp(argv[argn], "--rev=", 6) == 0)
+                            gitRev = argv[argn] + 6;
+                        else if (strncmp(argv[argn], "--history=", 10) == 0)
+                            gitHistory = argv[argn] + 10;
+                        else if (strncmp(argv[argn], "--jobs=", 7) == 0)
+                            parseJobs = (int)strtol(argv[argn] + 7, 0, 10);
+                        else if (strncmp(argv[argn], "--shard-out=", 12) == 0)
+                            shardOut = argv[argn] + 12;
+                        else if (strncmp(argv[argn], "--import-prefix=", 16) == 0)
+                        {
+                            Split prefixes(argv[argn] + 16, ",", FindSplit);
+                            for (size_t idx = 0; idx != prefixes.size(); idx++)
+                                importPrefixes.add(prefixes[idx]);
+                        }
+                        else if (strncmp(argv[argn], "--focus=", 8) == 0)
+                            focusClasses.push_back(argv[argn] + 8);
+                        else if (strcmp(argv[argn], "--focus-dir=up") == 0)
+                            focusDir = FOCUS_UP;
+                        else if (strcmp(argv[argn], "--focus-dir=down") == 0)
+                            focusDir = FOCUS_DOWN;
+                        else if (strcmp(argv[argn], "--focus-dir=both") == 0)
+                            focusDir = FOCUS_BOTH;
+                        else if (strncmp(argv[argn], "--subtype=", 10) == 0)
+                            subtypeQueries.push_back(argv[argn] + 10);
+                        else if (strcmp(argv[argn], "--resolve") == 0)
+                            resolveNames = true;
+                        else if (strcmp(argv[argn], "--packages") == 0)
+                        {
+                            resolveNames = true;
+                            packageDepth = 0;
+                        }
+                        else if (strncmp(argv[argn], "--packages=", 11) == 0)
+                        {
+                            resolveNames = true;
+                            packageDepth = (int)strtol(argv[argn] + 11, 0, 10);
+                        }
+                        else if (strcmp(argv[argn], "--merge") == 0)
+                            mergeShards = true;
+                        else if (strncmp(argv[argn], "--save-graph=", 13) == 0)
+                            saveGraph = argv[argn] + 13;
+                        else if (strncmp(argv[argn], "--load-graph=", 13) == 0)
+                        {
+                            LoadGraph(argv[argn] + 13);
+                            AddServeScan(argv[argn] + 13, true, ignorePatterns);
+                        }
+                        else if (strncmp(argv[argn], "--diff=", 7) == 0)
+                            diffGraph = argv[argn] + 7;
+                        else if (strncmp(argv[argn], "--impact=", 9) == 0)
+                            impactFiles = argv[argn] + 9;
+                        else if (strncmp(argv[argn], "--serve=", 8) == 0)
+                            servePath = argv[argn] + 8;
+                        else if (strcmp(argv[argn], "--watch") == 0)
+                            watchSources = true;
+                        else if (strncmp(argv[argn], "--watch=", 8) == 0)
+                        {
+                            watchSources = true;
+                            watchReport = argv[argn] + 8;
+                        }
+                        else if (strncmp(argv[argn], "--lazy-tree=", 12) == 0)
+                            lazyTreeDir = argv[argn] + 12;
+                        else if (strncmp(argv[argn], "--table-dir=", 12) == 0)
+                            ;   // opened before scanning
+                        else if (strcmp(argv[argn], "--parallel-emit") == 0)
+                            parallelEmit = true;
+                        else if (strncmp(argv[argn], "--render=", 9) == 0)
+                            renderFormat = argv[argn] + 9;
+                        else
+                            cerr << "Unknown option " << argv[argn] << endl;
+                        break;
                     case 'O':   // -O=<outPath>
                         outPath = argv[argn]+3;
                         break;
@@ -1539,18 +3652,103 @@ int main(int argc, char* argv[])
             {
                 codePath = argv[argn];
                 MakeTitle(codePath);
-                size_t fileCnt = FindClassDefinitions(argv[argn], ignorePatterns);
+                if (resolveNames && !gitHistory.empty())
+                {
+                    cerr << "Classtree: --resolve ignored with --history\n";
+                    resolveNames = false;
+                }
+                size_t fileCnt = ScanPath(argv[argn], ignorePatterns);
                 std::cerr << fileCnt << " Files parsed, " << clist.size() << " classes found\n";
+                AddServeScan(argv[argn], false, ignorePatterns);
             }
         }            
+
+        if (resolveNames)
+            ResolveClassDecls();
+        if (!focusClasses.empty() && gitHistory.empty())
+            std::cerr << FocusClassList() << " classes in focus\n";
+        if (packageDepth >= 0 && gitHistory.empty() && !importPackage && !tabularList)
+            AggregatePackages();
     
-        if (cset == VIZ_CHAR)
+        if (!gitHistory.empty())
         {
-            display_dependences();
+            Release_clist();    // metrics already reported per commit
+        }
+        else if (importPackage)
+        {
+            display_imports();
+        }
+        else if (!subtypeQueries.empty())
+        {
+            size_t failed = SubtypeQueries();
+            if (failed != 0)
+            {
+                std::cerr << failed << " subtype checks failed\n";
+                exitCode = 1;
+            }
+            Release_clist();
+        }
+        else if (!impactFiles.empty())
+        {
+            if (!ImpactOfChanges(impactFiles))
+                exitCode = 1;
+            Release_clist();
+        }
+        else if (!diffGraph.empty())
+        {
+            if (codePath.empty())
+                MakeTitle(diffGraph.substr(diffGraph.rfind(',') + 1));
+            if (!DiffGraphs(diffGraph))
+                exitCode = 1;
+            Release_clist();
+        }
+        else if (!saveGraph.empty())
+        {
+            GraphSnapshot::save(saveGraph, clist, fileClasses);
+            Release_clist();
+        }
+        else if (watchSources)
+        {
+            if (tabularList || importPackage || !focusClasses.empty() || packageDepth >= 0)
+                cerr << "Classtree: --watch needs class tree mode without --focus or --packages\n";
+            else if (watchReport.empty() && servePath.empty())
+                cerr << "Classtree: --watch needs a report file or --serve\n";
+            else if (!WatchSources())
+                exitCode = 1;
+            Release_clist();
+        }
+        else if (!servePath.empty())
+        {
+            std::string image;
+            GraphSnapshot::build(image, clist, fileClasses);
+            Release_clist();
+
+            GraphServer server(servePath, RescanGraph);
+            if (!server.publish(image) || !server.run())
+                exitCode = 1;
+        }
+        else if (!lazyTreeDir.empty())
+        {
+            SortChildren();
+            LazyTree lazyTree;
+            if (!lazyTree.write(lazyTreeDir, graphName, clist))
+                exitCode = 1;
+            Release_clist();
+        }
+        else if (!shardOut.empty())
+        {
+            if (importPackage || tabularList)
+                cerr << "Classtree: --shard-out needs class tree mode\n";
+            else
+                WriteShard(shardOut);
             Release_clist();
-            // outVizTrailer();
         }
-        else if (tabularList)
+        else if (!tableDir.empty())
+        {
+            if (!tableWriter.close(graphName))
+                exitCode = 1;
+        }
+        else if (tabularList && cset != VIZ_CHAR)
         {
             outputHtmlPrefix1();
             outputHtmlMetaHeader2();
@@ -1566,59 +3764,29 @@ int main(int argc, char* argv[])
                 "</html> \n"
                 "\n";
         }
-        else if (cset == JAVA_CHAR)
-        {
-            outputHtmlPrefix1();
-            outputHtmlMetaHeader2();
-            outputHtmlTitle3(graphName);
-#if 1
-            cout <<
-                "	<link rel=StyleSheet href=dtree/dtree.css type=text/css /> \n"
-                "	<script type=text/javascript src=dtree/dtree.js></script>  \n";
-#else
-            cout << "<style>\n" << dtree_css << "\n</style>\n";
-            cout << "<script type=\"text/javascript\">\n" << dtree_js << "\n</script>\n";
-#endif
-             cout <<
-                "</head>           \n"
-                "<body>            \n"
-                "<h2>Example</h2>  \n"
-                "<div class=dtree> \n"
-                "	<p><a href=javascript:d.openAll();>open all</a> | <a href=javascript:d.closeAll();>close all</a></p>  \n"
-                "	<script type=text/javascript> \n"
-                "		<!--                \n"
-                "		d = new dTree('d'); \n"
-                        "       d.add(0, -1, '" << graphName << "');\n";
-
-            display_dependences();
-            Release_clist();
-
-            cout << 
-                "		document.write(d); \n"
-                "       d.openAll();\n"
-                "		//--> \n"
-                "	</script> \n"
-                "</div>  \n"
-                "</body> \n"
-                "</html> \n"
-                "\n";
-        }
         else
         {
-            fputs(doc_begin[cset], stdout);
-                        
-            if (show_names) 
-                display_names();
-            if (show_tree)  
-                display_dependences();
-            
+            OutputClassTree();
             Release_clist();
 
-            fputs(doc_end[cset], stdout);
+            if (!renderFormat.empty())
+            {
+                if (cset != VIZ_CHAR || outPath.empty())
+                    std::cerr << "Classtree: --render needs -z with -O\n";
+                else
+                {
+                    size_t jobs = (parseJobs > 0) ? parseJobs : std::thread::hardware_concurrency();
+                    VizRender render(renderFormat, jobs, outPath + ".render-cache");
+                    for (size_t idx = 0; idx != vizFiles.size(); idx++)
+                        render.add(vizFiles[idx]);
+                    if (!render.run())
+                        exitCode = 1;
+                    std::cerr << "Rendered " << render.rendered() << ", unchanged " << render.skipped() << std::endl;
+                }
+            }
         }
-
         std::cerr << std::endl;
     }
 
-    return 0;
+    return exitCode;
 }
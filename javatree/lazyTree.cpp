@@ -0,0 +1,331 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: lazyTree.cpp
+// Author: Dennis Lang
+// Desc: Interactive html class tree, subtrees load from JSON fragment files on expand.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lazyTree.h"
+#include "JsonString.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_WIN
+#include <direct.h>
+#define mkdir(path, mode) _mkdir(path)
+#endif
+
+static const char sPageHead[] =
+    "<!DOCTYPE html>\n"
+    "<html>\n"
+    "<head>\n"
+    "<meta charset=\"utf-8\">\n"
+    "<style>\n"
+    "body { font-family: Verdana, Arial, sans-serif; font-size: 12px; }\n"
+    "ul.jt { list-style: none; margin: 0; padding-left: 18px; }\n"
+    "ul.jt li { white-space: nowrap; line-height: 18px; }\n"
+    "ul.jt span.t { display: inline-block; width: 14px; color: #666; cursor: pointer; }\n"
+    "</style>\n";
+
+// One click handler for the whole tree. A node's child list is built the
+// first time it opens and only hidden when closed.
+static const char sPageScript[] =
+    "<script>\n"
+    "var jt = {\n"
+    "  pending: {},\n"
+    "  lists: {},\n"
+    "  loaded: {},\n"
+    "  tree: document.getElementById('tree'),\n"
+    "  chunk: function(id, kids) {\n"
+    "    var li = this.pending[id];\n"
+    "    delete this.pending[id];\n"
+    "    if (li) { li.data = kids; this.open(li); }\n"
+    "    else if (id == 0) this.add(this.tree, kids);\n"
+    "    else this.lists[id] = kids;\n"
+    "  },\n"
+    "  add: function(ul, kids) {\n"
+    "    var frag = document.createDocumentFragment();\n"
+    "    for (var i = 0; i < kids.length; i++) {\n"
+    "      var kid = kids[i], li = document.createElement('li'), t = document.createElement('span');\n"
+    "      t.className = 't';\n"
+    "      t.textContent = kid[2] ? '+' : '\\u00a0';\n"
+    "      li.appendChild(t);\n"
+    "      li.appendChild(document.createTextNode(kid[0]));\n"
+    "      li.title = kid[1];\n"
+    "      li.data = kid[2];\n"
+    "      li.frag = kid[3];\n"
+    "      frag.appendChild(li);\n"
+    "    }\n"
+    "    ul.appendChild(frag);\n"
+    "  },\n"
+    "  open: function(li) {\n"
+    "    var ul = document.createElement('ul');\n"
+    "    ul.className = 'jt';\n"
+    "    this.add(ul, li.data);\n"
+    "    li.appendChild(ul);\n"
+    "    li.firstChild.textContent = '-';\n"
+    "  },\n"
+    "  toggle: function(li) {\n"
+    "    var ul = li.lastChild;\n"
+    "    if (ul.nodeName == 'UL') {\n"
+    "      var hide = ul.style.display != 'none';\n"
+    "      ul.style.display = hide ? 'none' : '';\n"
+    "      li.firstChild.textContent = hide ? '+' : '-';\n"
+    "    } else if (typeof li.data == 'number') {\n"
+    "      var kids = this.lists[li.data];\n"
+    "      if (kids) { delete this.lists[li.data]; li.data = kids; this.open(li); return; }\n"
+    "      if (this.pending[li.data]) return;\n"
+    "      this.pending[li.data] = li;\n"
+    "      if (this.loaded[li.frag]) return;\n"
+    "      this.loaded[li.frag] = 1;\n"
+    "      var s = document.createElement('script');\n"
+    "      s.src = 't' + li.frag + '.js';\n"
+    "      document.body.appendChild(s);\n"
+    "    } else\n"
+    "      this.open(li);\n"
+    "  }\n"
+    "};\n"
+    "jt.tree.onclick = function(e) {\n"
+    "  var t = e.target;\n"
+    "  if (t.className == 't' && t.parentNode.data) jt.toggle(t.parentNode);\n"
+    "};\n";
+
+// ---------------------------------------------------------------------------
+static void HtmlText(std::ostream& out, const lstring& text)
+{
+    for (size_t idx = 0; idx != text.length(); idx++)
+    {
+        switch (text[idx])
+        {
+        case '<': out << "&lt;"; break;
+        case '>': out << "&gt;"; break;
+        case '&': out << "&amp;"; break;
+        default:  out << text[idx]; break;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+LazyTree::LazyTree(size_t chunkSize) :
+    my_chunkSize(chunkSize),
+    my_nextId(1)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+// True if crel is already on the path from the root to entryIdx, its
+// subtree would repeat forever on an inheritance cycle.
+bool LazyTree::onPath(const EntryList& entries, int entryIdx, const ClassPath& path, const ClassRelations* crel) const
+{
+    for (int idx = entryIdx; idx >= 0; idx = entries[idx].parent)
+    {
+        if (entries[idx].crel == crel)
+            return true;
+    }
+    for (size_t idx = 0; idx != path.size(); idx++)
+    {
+        if (path[idx] == crel)
+            return true;
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Breadth first fill of one list appended to a fragment, the top level
+// always goes in. A node whose children would overflow the fragment is
+// queued as a new list.
+void LazyTree::pack(const ClassPath& top, const ClassPath& path, EntryList& entries)
+{
+    size_t first = entries.size();
+    for (size_t idx = 0; idx != top.size(); idx++)
+    {
+        Entry entry = { top[idx], -1, 0, 0, -1 };
+        entries.push_back(entry);
+    }
+
+    ClassPath kids;
+    for (size_t entryIdx = first; entryIdx != entries.size(); entryIdx++)
+    {
+        const ClassRelations* crel_ptr = entries[entryIdx].crel;
+        kids.clear();
+        for (const ClassLinkage* link_ptr = &crel_ptr->children(); link_ptr != NULL; link_ptr = link_ptr->linkage)
+        {
+            if (link_ptr->relations != NULL && !onPath(entries, (int)entryIdx, path, link_ptr->relations))
+                kids.push_back(link_ptr->relations);
+        }
+        if (kids.empty())
+            continue;
+
+        if (entries.size() + kids.size() <= my_chunkSize)
+        {
+            entries[entryIdx].firstChild = entries.size();
+            entries[entryIdx].childCount = kids.size();
+            for (size_t idx = 0; idx != kids.size(); idx++)
+            {
+                Entry entry = { kids[idx], (int)entryIdx, 0, 0, -1 };
+                entries.push_back(entry);
+            }
+        }
+        else
+        {
+            Job job;
+            job.id = my_nextId++;
+            job.path = path;
+            size_t depth = job.path.size();
+            for (int idx = (int)entryIdx; idx >= 0; idx = entries[idx].parent)
+                job.path.insert(job.path.begin() + depth, entries[idx].crel);
+            entries[entryIdx].list = job.id;
+            my_jobs.push_back(job);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void LazyTree::writeEntries(std::ostream& out, const EntryList& entries, size_t first, size_t count) const
+{
+    out << '[';
+    for (size_t idx = first; idx != first + count; idx++)
+    {
+        const Entry& entry = entries[idx];
+        if (idx != first)
+            out << ",\n";
+        out << '[';
+        JsonString(out, entry.crel->name().c_str()) << ',';
+        JsonString(out, entry.crel->file().c_str());
+        if (entry.childCount != 0)
+        {
+            out << ',';
+            writeEntries(out, entries, entry.firstChild, entry.childCount);
+        }
+        else if (entry.list >= 0)
+            out << ',' << entry.list << ',' << my_listFragment[entry.list];
+        out << ']';
+    }
+    out << ']';
+}
+
+//-------------------------------------------------------------------------------------------------
+bool LazyTree::write(const lstring& outDir, const lstring& title, const ClassList& clist)
+{
+    if (mkdir(outDir.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        std::cerr << "Classtree: Unable to create " << outDir << " " << strerror(errno) << std::endl;
+        return false;
+    }
+    lstring dirPath = outDir;
+    if (dirPath.empty() || dirPath[dirPath.length() - 1] != '/')
+        dirPath += "/";
+
+    ClassPath top;
+    for (ClassList::const_iterator iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        if (iter->second->parents().relations == NULL)
+            top.push_back(iter->second);
+    }
+
+    // Pack every list first, a node names the fragment of its child list
+    // and that is only known once the list is packed.
+    my_nextId = 1;
+    my_jobs.clear();
+    my_fragments.assign(1, Fragment());
+    my_listFragment.assign(1, 0);
+    pack(top, ClassPath(), my_fragments[0].entries);
+    List topList = { 0, 0, top.size() };
+    my_fragments[0].lists.push_back(topList);
+
+    while (!my_jobs.empty())
+    {
+        Job job = my_jobs.front();
+        my_jobs.pop_front();
+
+        const ClassRelations* crel_ptr = job.path.back();
+        ClassPath kids;
+        for (const ClassLinkage* link_ptr = &crel_ptr->children(); link_ptr != NULL; link_ptr = link_ptr->linkage)
+        {
+            if (link_ptr->relations != NULL
+                && std::find(job.path.begin(), job.path.end(), link_ptr->relations) == job.path.end())
+                kids.push_back(link_ptr->relations);
+        }
+
+        if (my_fragments.size() == 1
+            || my_fragments.back().entries.size() + kids.size() > my_chunkSize)
+            my_fragments.push_back(Fragment());
+        Fragment& fragment = my_fragments.back();
+        List list = { job.id, fragment.entries.size(), kids.size() };
+        pack(kids, job.path, fragment.entries);
+        fragment.lists.push_back(list);
+        if (my_listFragment.size() <= (size_t)job.id)
+            my_listFragment.resize(job.id + 1, 0);
+        my_listFragment[job.id] = (int)my_fragments.size() - 1;
+    }
+
+    lstring indexPath = dirPath + "index.html";
+    std::ofstream index(indexPath.c_str());
+    index << sPageHead << "<title>";
+    HtmlText(index, title);
+    index << "</title>\n</head>\n<body>\n<h2>";
+    HtmlText(index, title);
+    index << "</h2>\n<ul class=\"jt\" id=\"tree\"></ul>\n" << sPageScript << "jt.chunk(0,";
+    writeEntries(index, my_fragments[0].entries, 0, top.size());
+    index << ");\n</script>\n</body>\n</html>\n";
+    index.close();
+    if (index.fail())
+    {
+        std::cerr << "Classtree: Unable to write " << indexPath << std::endl;
+        return false;
+    }
+
+    for (size_t fragIdx = 1; fragIdx != my_fragments.size(); fragIdx++)
+    {
+        const Fragment& fragment = my_fragments[fragIdx];
+        std::ostringstream fragPath;
+        fragPath << dirPath << 't' << fragIdx << ".js";
+        std::ofstream frag(fragPath.str().c_str());
+        for (size_t idx = 0; idx != fragment.lists.size(); idx++)
+        {
+            const List& list = fragment.lists[idx];
+            frag << "jt.chunk(" << list.id << ',';
+            writeEntries(frag, fragment.entries, list.first, list.count);
+            frag << ");\n";
+        }
+        frag.close();
+        if (frag.fail())
+        {
+            std::cerr << "Classtree: Unable to write " << fragPath.str() << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,115 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: lazyTree.h
+// Author: Dennis Lang
+// Desc: Interactive html class tree, subtrees load from JSON fragment files on expand.
+//
+// Usage:
+//      LazyTree tree;
+//      tree.write("classTree", title, clist);    // open classTree/index.html
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "class_rel.h"
+#include <deque>
+#include <ostream>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Same tree as -j (classes without a parent at the top, children below)
+// split into fragments. index.html holds the top level and as many levels
+// below it as fit in one fragment. Every node whose children did not fit
+// names a child list N kept in fragment file t<F>.js. Pending lists share
+// fragment files until a file holds about chunkSize nodes. The page loads
+// a file with a script tag when one of its nodes is first opened (works
+// from file:// too) and keeps its other lists until they are opened. Each
+// node is turned into DOM once, when its parent opens, so building the
+// page is linear in the nodes shown.
+//
+//  node = ["name", "file"]                 leaf
+//       | ["name", "file", [node, ...]]    children inline
+//       | ["name", "file", N, F]           children list N in tF.js
+//
+class LazyTree
+{
+public:
+    LazyTree(size_t chunkSize = 2000);
+
+    // Write outDir/index.html and fragment files, return false on write error.
+    bool write(const lstring& outDir, const lstring& title, const ClassList& clist);
+
+    size_t fragmentCount() const
+    { return my_fragments.size(); }
+
+private:
+    typedef std::vector<const ClassRelations*> ClassPath;
+
+    struct Entry
+    {
+        const ClassRelations* crel;
+        int     parent;             // entry index, -1 at top of fragment
+        size_t  firstChild;
+        size_t  childCount;
+        int     list;               // children in list of a fragment file, -1 if none
+    };
+    typedef std::vector<Entry> EntryList;
+
+    struct Job
+    {
+        int         id;             // list id
+        ClassPath   path;           // root to node whose children it holds
+    };
+
+    struct List
+    {
+        int     id;
+        size_t  first;              // top entries of list
+        size_t  count;
+    };
+
+    // index.html is fragment 0 holding list 0, the classes without a parent.
+    struct Fragment
+    {
+        EntryList         entries;
+        std::vector<List> lists;
+    };
+
+    void pack(const ClassPath& top, const ClassPath& path, EntryList& entries);
+    bool onPath(const EntryList& entries, int entryIdx, const ClassPath& path, const ClassRelations* crel) const;
+    void writeEntries(std::ostream& out, const EntryList& entries, size_t first, size_t count) const;
+
+    size_t          my_chunkSize;
+    int             my_nextId;
+    std::deque<Job> my_jobs;
+    std::vector<Fragment> my_fragments;
+    std::vector<int> my_listFragment;      // list id to fragment
+};
@@ -0,0 +1,260 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: packageGraph.cpp
+// Author: Dennis Lang
+// Desc: Collapse the class graph into package nodes with weighted edges.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "packageGraph.h"
+#include "javaTree.h"
+#include <algorithm>
+#include <ctype.h>
+#include <sstream>
+#include <stdint.h>
+#include <unordered_map>
+
+static const lstring sDefaultPackage("_default_");
+
+// ---------------------------------------------------------------------------
+lstring PackageOf(const lstring& name)
+{
+    size_t end = 0;
+    size_t pos = 0;
+    while (pos < name.length() && islower((unsigned char)name[pos]))
+    {
+        size_t dot = name.find_first_of(".<", pos);
+        if (dot == lstring::npos || name[dot] != '.')
+            break;
+        end = dot;
+        pos = dot + 1;
+    }
+    return name.substr(0, end);
+}
+
+// ---------------------------------------------------------------------------
+// Package link and the number of class relations behind it.
+struct PackageLink
+{
+    uint32_t from;      // super class or interface package
+    uint32_t to;
+    VizGraph::Edge kind;
+    unsigned count;
+
+    bool operator<(const PackageLink& other) const
+    {
+        if (from != other.from)
+            return from < other.from;
+        if (to != other.to)
+            return to < other.to;
+        return kind < other.kind;
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+PackageGraph::PackageGraph(unsigned depth) :
+    my_depth(depth)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+lstring PackageGraph::packageName(const lstring& className) const
+{
+    lstring package = PackageOf(className);
+    if (package.empty())
+        return sDefaultPackage;
+
+    size_t pos = 0;
+    for (unsigned segment = 0; my_depth != 0 && segment != my_depth; segment++)
+    {
+        pos = package.find('.', pos);
+        if (pos == lstring::npos)
+            return package;
+        if (segment + 1 != my_depth)
+            pos++;
+    }
+    if (my_depth != 0)
+        package.resize(pos);
+    return package;
+}
+
+//-------------------------------------------------------------------------------------------------
+void PackageGraph::build(const ClassList& clist, ClassList& packages)
+{
+    my_rootLinks.clear();
+    my_weights.clear();
+
+    std::unordered_map<std::string, uint32_t> packageIds;
+    std::vector<lstring> names;
+    std::vector<size_t> declared;
+    std::unordered_map<const ClassRelations*, uint32_t> classPackage;
+    for (ClassList::const_iterator iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> found =
+            packageIds.insert(std::make_pair(packageName(iter->first), (uint32_t)names.size()));
+        if (found.second)
+        {
+            names.push_back(found.first->first);
+            declared.push_back(0);
+        }
+        classPackage[iter->second] = found.first->second;
+        if (iter->second->file() != nofile)
+            declared[found.first->second]++;
+    }
+
+    // Count class relations per package pair, links inside a package are dropped.
+    std::unordered_map<uint64_t, unsigned> counts[2];
+    for (ClassList::const_iterator iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        uint32_t to = classPackage[iter->second];
+        const ClassLinkage* lists[2] = { &iter->second->parents(), &iter->second->interfaces() };
+        for (unsigned kind = 0; kind != 2; kind++)
+        {
+            for (const ClassLinkage* link_ptr = lists[kind]; link_ptr != NULL; link_ptr = link_ptr->linkage)
+            {
+                if (link_ptr->relations == NULL)
+                    continue;
+                uint32_t from = classPackage[link_ptr->relations];
+                if (from != to)
+                    counts[kind][((uint64_t)from << 32) | to]++;
+            }
+        }
+    }
+
+    std::vector<PackageLink> links;
+    for (unsigned kind = 0; kind != 2; kind++)
+    {
+        for (std::unordered_map<uint64_t, unsigned>::const_iterator iter = counts[kind].begin(); iter != counts[kind].end(); iter++)
+        {
+            PackageLink link = { (uint32_t)(iter->first >> 32), (uint32_t)iter->first, (VizGraph::Edge)kind, iter->second };
+            links.push_back(link);
+        }
+    }
+    std::sort(links.begin(), links.end());
+
+    // Depth first walk of extends links from packages without a super
+    // package, a link back to a package still on the walk closes a cycle.
+    std::vector<std::vector<size_t> > subLinks(names.size());
+    std::vector<bool> hasSuper(names.size(), false);
+    for (size_t idx = 0; idx != links.size(); idx++)
+    {
+        if (links[idx].kind == VizGraph::EXTENDS)
+        {
+            subLinks[links[idx].from].push_back(idx);
+            hasSuper[links[idx].to] = true;
+        }
+    }
+    enum { UNSEEN, ON_WALK, DONE };
+    std::vector<unsigned char> state(names.size(), UNSEEN);
+    std::vector<bool> cycleLink(links.size(), false);
+    std::vector<std::pair<uint32_t, size_t> > walk;     // package, next sub link
+    for (unsigned pass = 0; pass != 2; pass++)
+    {
+        for (uint32_t start = 0; start != names.size(); start++)
+        {
+            if (state[start] != UNSEEN || (pass == 0 && hasSuper[start]))
+                continue;
+            state[start] = ON_WALK;
+            walk.push_back(std::make_pair(start, 0));
+            while (!walk.empty())
+            {
+                uint32_t package = walk.back().first;
+                if (walk.back().second == subLinks[package].size())
+                {
+                    state[package] = DONE;
+                    walk.pop_back();
+                    continue;
+                }
+                size_t linkIdx = subLinks[package][walk.back().second++];
+                uint32_t sub = links[linkIdx].to;
+                if (state[sub] == ON_WALK)
+                    cycleLink[linkIdx] = true;
+                else if (state[sub] == UNSEEN)
+                {
+                    state[sub] = ON_WALK;
+                    walk.push_back(std::make_pair(sub, 0));
+                }
+            }
+        }
+    }
+
+    std::vector<ClassRelations*> nodes(names.size());
+    for (size_t idx = 0; idx != names.size(); idx++)
+    {
+        std::ostringstream classes;
+        classes << declared[idx] << " classes";
+        nodes[idx] = new ClassRelations(names[idx], "public", classes.str());
+        packages.insert(std::make_pair(names[idx], nodes[idx]));
+    }
+
+    // Heaviest acyclic extends link of each package is its tree parent,
+    // walking every parent would repeat subtrees once per path. Other
+    // links, cycle closing ones too, only list the super package as one
+    // more parent. A package without a tree parent stays a root.
+    const size_t NO_LINK = (size_t)-1;
+    std::vector<size_t> treeLink(names.size(), NO_LINK);
+    for (size_t idx = 0; idx != links.size(); idx++)
+    {
+        if (links[idx].kind == VizGraph::EXTENDS && !cycleLink[idx])
+        {
+            size_t& best = treeLink[links[idx].to];
+            if (best == NO_LINK || links[idx].count > links[best].count)
+                best = idx;
+        }
+    }
+
+    // Tree parents first so other parents follow in the parents list.
+    for (unsigned pass = 0; pass != 2; pass++)
+    {
+        for (size_t idx = 0; idx != links.size(); idx++)
+        {
+            const PackageLink& link = links[idx];
+            bool isTree = (treeLink[link.to] == idx);
+            if ((pass == 0) != isTree)
+                continue;
+            ClassRelations* from_ptr = nodes[link.from];
+            ClassRelations* to_ptr = nodes[link.to];
+            VizGraph::EdgeKey key = { from_ptr, to_ptr, link.kind };
+            if (link.kind == VizGraph::EXTENDS && treeLink[link.to] == NO_LINK)
+                my_rootLinks.push_back(key);
+            else if (link.kind == VizGraph::EXTENDS)
+            {
+                to_ptr->add_parent(from_ptr);
+                if (isTree)
+                    from_ptr->add_child(to_ptr);
+            }
+            else
+            {
+                to_ptr->add_interface(from_ptr);
+                from_ptr->add_implementer(to_ptr);
+            }
+            my_weights[key] = link.count;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: packageGraph.h
+// Author: Dennis Lang
+// Desc: Collapse the class graph into package nodes with weighted edges.
+//
+// Usage:
+//      PackageGraph packageGraph(2);           // com.wsi, 0 for whole package names
+//      packageGraph.build(clist, packages);    // packages replaces clist
+//      vizGraph.weights(&packageGraph.weights());
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "class_rel.h"
+#include "vizGraph.h"
+
+// Leading lower case segments of a package qualified name, com.a.Base.Inner
+// is in com.a. Empty when the name has no package.
+lstring PackageOf(const lstring& name);
+
+// ---------------------------------------------------------------------------
+// Package view of the class graph for trees too big to lay out. Each
+// package, optionally cut to its first depth segments, becomes one node
+// and a class extending or implementing a class of another package links
+// the two packages. The package list uses the same ClassRelations links as
+// classes so every emitter and -Z/-N splitting works on it unchanged. The
+// number of class relations behind each link is kept as its weight.
+// A package lists all its super packages as parents but is a child of
+// one only, chosen so the child links form a forest, and the tree
+// emitters show each package once.
+class PackageGraph
+{
+public:
+    PackageGraph(unsigned depth = 0);
+
+    // Fill packages (empty) from clist in one pass over the class links.
+    // Package node file is its declared class count.
+    void build(const ClassList& clist, ClassList& packages);
+
+    const VizGraph::EdgeWeights& weights() const
+    { return my_weights; }
+
+    // Extends links into packages on a cycle with no tree parent. Such a
+    // package is kept as a root, so the link is not one of its parents and
+    // is only drawn as an edge by -z.
+    typedef std::vector<VizGraph::EdgeKey> EdgeList;
+    const EdgeList& rootLinks() const
+    { return my_rootLinks; }
+
+private:
+    lstring packageName(const lstring& className) const;
+
+    unsigned    my_depth;
+    EdgeList    my_rootLinks;
+    VizGraph::EdgeWeights my_weights;
+};
@@ -0,0 +1,168 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: parallelEmit.cpp
+// Author: Dennis Lang
+// Desc: Write one large output file from pieces rendered on several threads.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "parallelEmit.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifndef HAVE_WIN
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+//-------------------------------------------------------------------------------------------------
+ParallelEmit::ParallelEmit(size_t jobs) :
+    my_jobs(jobs != 0 ? jobs : 1)
+{
+}
+
+#ifdef HAVE_WIN
+
+bool ParallelEmit::canWrite(int fd)
+{
+    return false;
+}
+
+bool ParallelEmit::write(int fd, size_t count, const LengthFn& length, const RenderFn& render)
+{
+    return false;
+}
+
+#else
+
+//-------------------------------------------------------------------------------------------------
+bool ParallelEmit::canWrite(int fd)
+{
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+        return false;
+    int flags = fcntl(fd, F_GETFL);
+    return flags >= 0 && (flags & O_APPEND) == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool ParallelEmit::write(int fd, size_t count, const LengthFn& length, const RenderFn& render)
+{
+    off_t base = lseek(fd, 0, SEEK_CUR);
+    if (base < 0)
+        return false;
+    size_t jobs = std::max((size_t)1, std::min(my_jobs, count));
+
+    auto runJobs = [&](const std::function<void()>& worker)
+    {
+        std::vector<std::thread> threads;
+        for (size_t job = 1; job < jobs; job++)
+            threads.push_back(std::thread(worker));
+        worker();
+        for (size_t job = 0; job != threads.size(); job++)
+            threads[job].join();
+    };
+
+    // Pass 1, piece lengths.
+    std::vector<size_t> lengths(count);
+    std::atomic<size_t> nextIdx(0);
+    runJobs([&]()
+    {
+        size_t idx;
+        while ((idx = nextIdx++) < count)
+            lengths[idx] = length(idx);
+    });
+
+    std::vector<off_t> offsets(count);
+    off_t total = 0;
+    for (size_t idx = 0; idx != count; idx++)
+    {
+        offsets[idx] = base + total;
+        total += (off_t)lengths[idx];
+    }
+    if (total == 0)
+        return true;
+
+#ifdef __linux__
+    if (posix_fallocate(fd, base, total) != 0 && ftruncate(fd, base + total) != 0)
+        return false;
+#else
+    if (ftruncate(fd, base + total) != 0)
+        return false;
+#endif
+
+    // Pass 2, largest pieces first so one deep tree does not finish last.
+    std::vector<size_t> order(count);
+    for (size_t idx = 0; idx != count; idx++)
+        order[idx] = idx;
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs)
+        { return lengths[lhs] > lengths[rhs]; });
+
+    std::atomic<bool> okay(true);
+    nextIdx = 0;
+    runJobs([&]()
+    {
+        std::vector<char> buffer;
+        size_t pos;
+        while ((pos = nextIdx++) < count && okay)
+        {
+            size_t idx = order[pos];
+            if (lengths[idx] == 0)
+                continue;
+            buffer.resize(lengths[idx]);
+            render(idx, buffer.data());
+
+            const char* data = buffer.data();
+            size_t remain = lengths[idx];
+            off_t offset = offsets[idx];
+            while (remain != 0)
+            {
+                ssize_t wrote = pwrite(fd, data, remain, offset);
+                if (wrote <= 0)
+                {
+                    okay = false;
+                    break;
+                }
+                data += wrote;
+                offset += wrote;
+                remain -= (size_t)wrote;
+            }
+        }
+    });
+
+    lseek(fd, base + total, SEEK_SET);
+    return okay;
+}
+
+#endif
@@ -0,0 +1,68 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: parallelEmit.h
+// Author: Dennis Lang
+// Desc: Write one large output file from pieces rendered on several threads.
+//
+// Usage:
+//      ParallelEmit emit(8);
+//      if (ParallelEmit::canWrite(1))
+//          emit.write(1, roots.size(), lengthOfRoot, renderRoot);
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include <functional>
+#include <stddef.h>
+
+// ---------------------------------------------------------------------------
+// Pieces (one per root subtree) are measured in parallel, their offsets
+// follow from the lengths, the file is extended once to the total size and
+// each piece is rendered and pwrite() at its own offset. The result is byte
+// for byte what writing the pieces in order would give.
+class ParallelEmit
+{
+public:
+    typedef std::function<size_t (size_t idx)> LengthFn;                // exact bytes of piece
+    typedef std::function<void (size_t idx, char* dest)> RenderFn;     // fill exactly length bytes
+
+    ParallelEmit(size_t jobs);
+
+    // True if fd is a regular file without O_APPEND, so pieces can be
+    // placed by offset.
+    static bool canWrite(int fd);
+
+    // Write pieces in index order at the current offset of fd, offset
+    // is left after the last piece.
+    bool write(int fd, size_t count, const LengthFn& length, const RenderFn& render);
+
+private:
+    size_t my_jobs;
+};
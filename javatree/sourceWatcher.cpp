@@ -0,0 +1,247 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: sourceWatcher.cpp
+// Author: Dennis Lang
+// Desc: Report changed files below watched source directories (inotify).
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "sourceWatcher.h"
+#include "directory.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+static const uint32_t WATCH_EVENTS = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE
+    | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF;
+#endif
+
+//-------------------------------------------------------------------------------------------------
+SourceWatcher::SourceWatcher() :
+    my_fd(-1)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+SourceWatcher::~SourceWatcher()
+{
+    close();
+}
+
+#ifndef __linux__
+
+bool SourceWatcher::open()
+{
+    std::cerr << "--watch not supported on this platform\n";
+    return false;
+}
+
+void SourceWatcher::close()
+{
+}
+
+size_t SourceWatcher::add(const lstring& dirPath, lstring& realPath)
+{
+    return 0;
+}
+
+size_t SourceWatcher::addTree(const lstring& dirPath, PathList* changed)
+{
+    return 0;
+}
+
+void SourceWatcher::removeTree(const lstring& dirPath)
+{
+}
+
+bool SourceWatcher::wait(PathList& changed, int timeoutMs, int settleMs)
+{
+    return false;
+}
+
+bool SourceWatcher::readEvents(PathList& changed)
+{
+    return false;
+}
+
+#else
+
+//-------------------------------------------------------------------------------------------------
+bool SourceWatcher::open()
+{
+    close();
+    my_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (my_fd < 0)
+        std::cerr << "Classtree: Unable to start inotify " << strerror(errno) << std::endl;
+    return my_fd >= 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+void SourceWatcher::close()
+{
+    if (my_fd >= 0)
+        ::close(my_fd);
+    my_fd = -1;
+    my_dirs.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SourceWatcher::add(const lstring& dirPath, lstring& realPath)
+{
+    char pathBuf[PATH_MAX];
+    struct stat info;
+    if (realpath(dirPath, pathBuf) == NULL || stat(pathBuf, &info) != 0 || !S_ISDIR(info.st_mode))
+        return 0;
+    realPath = pathBuf;
+    return addTree(realPath, NULL);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Watch dirPath and its subdirectories. A directory that appears after
+// the scan may already hold files, those are added to changed.
+size_t SourceWatcher::addTree(const lstring& dirPath, PathList* changed)
+{
+    int wd = inotify_add_watch(my_fd, dirPath, WATCH_EVENTS);
+    if (wd < 0)
+    {
+        std::cerr << "Classtree: Unable to watch " << dirPath << " " << strerror(errno) << std::endl;
+        return 0;
+    }
+    my_dirs[wd] = dirPath;
+
+    size_t dirCount = 1;
+    Directory_files directory(dirPath);
+    lstring fullname;
+    while (directory.more())
+    {
+        directory.fullName(fullname);
+        if (directory.is_directory())
+            dirCount += addTree(fullname, changed);
+        else if (changed != NULL)
+            changed->push_back(fullname);
+    }
+    return dirCount;
+}
+
+//-------------------------------------------------------------------------------------------------
+void SourceWatcher::removeTree(const lstring& dirPath)
+{
+    lstring prefix = dirPath + "/";
+    std::map<int, lstring>::iterator iter = my_dirs.begin();
+    while (iter != my_dirs.end())
+    {
+        if (iter->second == dirPath || iter->second.compare(0, prefix.length(), prefix) == 0)
+        {
+            inotify_rm_watch(my_fd, iter->first);
+            my_dirs.erase(iter++);
+        }
+        else
+            iter++;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Drain queued events, return false if nothing was queued.
+bool SourceWatcher::readEvents(PathList& changed)
+{
+    char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool gotEvent = false;
+    ssize_t length;
+    while ((length = read(my_fd, buffer, sizeof(buffer))) > 0)
+    {
+        gotEvent = true;
+        for (char* ptr = buffer; ptr < buffer + length; )
+        {
+            const struct inotify_event* event = (const struct inotify_event*)ptr;
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            std::map<int, lstring>::iterator iter = my_dirs.find(event->wd);
+            if (iter == my_dirs.end())
+                continue;
+            if (event->mask & (IN_DELETE_SELF | IN_IGNORED))
+            {
+                my_dirs.erase(iter);
+                continue;
+            }
+            if (event->len == 0)
+                continue;
+
+            lstring path = iter->second + "/" + event->name;
+            if (event->mask & IN_ISDIR)
+            {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    addTree(path, &changed);
+                else if (event->mask & IN_MOVED_FROM)
+                {
+                    // Files moved away with it get no events of their own.
+                    changed.push_back(path);
+                    removeTree(path);
+                }
+            }
+            else if (event->mask & (IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO))
+            {
+                changed.push_back(path);
+            }
+        }
+    }
+    return gotEvent;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool SourceWatcher::wait(PathList& changed, int timeoutMs, int settleMs)
+{
+    changed.clear();
+    if (my_fd < 0)
+        return false;
+
+    struct pollfd pfd;
+    pfd.fd = my_fd;
+    pfd.events = POLLIN;
+    int waitMs = timeoutMs;
+    while (poll(&pfd, 1, waitMs) > 0)
+    {
+        readEvents(changed);
+        waitMs = settleMs;
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return !changed.empty();
+}
+
+#endif
@@ -0,0 +1,84 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: sourceWatcher.h
+// Author: Dennis Lang
+// Desc: Report changed files below watched source directories (inotify).
+//
+// Usage:
+//      SourceWatcher watcher;
+//      if (watcher.open() && watcher.add("src") != 0)
+//          while (running)
+//              if (watcher.wait(changed, 200))
+//                  ...reparse changed files
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include <map>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Recursive directory watch. Paths are built the same way as a directory
+// scan (real directory path + '/' + name) so they match the file names
+// the scan recorded. Directories created later are watched as they appear
+// and files inside them are reported.
+class SourceWatcher
+{
+public:
+    typedef std::vector<lstring> PathList;
+
+    SourceWatcher();
+    ~SourceWatcher();
+
+    // Return false if watching is not supported.
+    bool open();
+    void close();
+
+    // Watch directory tree, return count of directories watched, 0 if
+    // dirPath is not a directory. Reported paths start with realPath.
+    size_t add(const lstring& dirPath, lstring& realPath);
+
+    // Wait up to timeoutMs for a change, then keep collecting until
+    // settleMs pass without one so a save of several files is one batch.
+    // Changed holds each created, modified, moved or deleted file once,
+    // a directory moved away is reported by its own path.
+    bool wait(PathList& changed, int timeoutMs, int settleMs = 15);
+
+private:
+    SourceWatcher(const SourceWatcher&);
+    SourceWatcher& operator=(const SourceWatcher&);
+
+    size_t addTree(const lstring& dirPath, PathList* changed);
+    void removeTree(const lstring& dirPath);
+    bool readEvents(PathList& changed);
+
+    int                     my_fd;
+    std::map<int, lstring>  my_dirs;    // watch descriptor to directory
+};
@@ -0,0 +1,114 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: splitManifest.cpp
+// Author: Dennis Lang
+// Desc: Rewrite split output files only when their content changed.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "splitManifest.h"
+#include "fnvHash.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+//-------------------------------------------------------------------------------------------------
+SplitManifest::SplitManifest() :
+    my_written(0),
+    my_unchanged(0)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+// Manifest line: <hash hex> <path>
+void SplitManifest::open(const lstring& manifestPath)
+{
+    my_path = manifestPath;
+    my_previous.clear();
+    my_current.clear();
+    my_written = my_unchanged = 0;
+
+    std::ifstream in(my_path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string hashStr, path;
+        if (!(fields >> hashStr) || !std::getline(fields >> std::ws, path))
+            continue;
+        my_previous[path.c_str()] = strtoull(hashStr.c_str(), NULL, 16);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+bool SplitManifest::write(const lstring& path, const std::string& content)
+{
+    uint64_t hash = FnvHash(content.data(), content.length());
+    my_current[path] = hash;
+
+    HashList::const_iterator prev = my_previous.find(path);
+    struct stat info;
+    if (prev != my_previous.end() && prev->second == hash
+        && stat(path, &info) == 0 && (size_t)info.st_size == content.length())
+    {
+        my_unchanged++;
+        return true;
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(content.data(), content.length());
+    out.close();
+    if (!out.good())
+    {
+        my_current.erase(path);
+        return false;
+    }
+    my_written++;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool SplitManifest::close()
+{
+    if (my_path.empty())
+        return true;
+
+    std::ofstream out(my_path);
+    char hashStr[20];
+    for (HashList::const_iterator iter = my_current.begin(); iter != my_current.end(); iter++)
+    {
+        snprintf(hashStr, sizeof(hashStr), "%016llx", (unsigned long long)iter->second);
+        out << hashStr << " " << iter->first << "\n";
+    }
+    my_path.clear();
+    return out.good();
+}
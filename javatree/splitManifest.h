@@ -0,0 +1,82 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: splitManifest.h
+// Author: Dennis Lang
+// Desc: Rewrite split output files only when their content changed.
+//
+// Usage:
+//      SplitManifest manifest;
+//      manifest.open("viz/.manifest");
+//      manifest.write("viz/Base.gv", content);    // skipped when unchanged
+//      manifest.close();
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include <map>
+#include <stdint.h>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Keeps the hash of each split output file (-Z, -N) from the previous run.
+// A file whose new content hashes the same and is still on disk is left
+// alone, so its timestamp and downstream caches (rsync, --render) stay
+// valid. Files not written this run drop out of the manifest.
+class SplitManifest
+{
+public:
+    SplitManifest();
+
+    // Load previous manifest, a missing file is an empty manifest.
+    void open(const lstring& manifestPath);
+
+    // Write content to path unless unchanged, false on write error.
+    bool write(const lstring& path, const std::string& content);
+
+    // Save hashes of files written or kept this run.
+    bool close();
+
+    bool isOpen() const
+    { return !my_path.empty(); }
+    size_t written() const
+    { return my_written; }
+    size_t unchanged() const
+    { return my_unchanged; }
+
+private:
+    typedef std::map<lstring, uint64_t> HashList;   // by file path
+
+    lstring     my_path;
+    HashList    my_previous;
+    HashList    my_current;
+    size_t      my_written;
+    size_t      my_unchanged;
+};
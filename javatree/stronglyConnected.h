@@ -0,0 +1,116 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: stronglyConnected.h
+// Author: Dennis Lang
+// Desc: Strongly connected components of a directed graph (Tarjan).
+//
+// Usage:
+//      AdjacencyList edges(nodeCount);
+//      std::vector<unsigned> component;
+//      unsigned count = StronglyConnected(edges, component);
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include <vector>
+#include <algorithm>
+
+typedef std::vector<std::vector<unsigned> > AdjacencyList;
+
+// ---------------------------------------------------------------------------
+// Tarjan with an explicit stack so deep chains can't overflow the call
+// stack. Components are numbered in reverse topological order, for every
+// edge v -> w component[v] >= component[w]. Return count of components.
+inline unsigned StronglyConnected(const AdjacencyList& edges, std::vector<unsigned>& component)
+{
+    const unsigned UNVISITED = (unsigned)-1;
+    size_t count = edges.size();
+    std::vector<unsigned> index(count, UNVISITED);
+    std::vector<unsigned> lowLink(count, 0);
+    std::vector<char> onStack(count, 0);
+    std::vector<unsigned> stack;
+    std::vector<std::pair<unsigned, size_t> > callStack;   // node, next edge
+    unsigned nextIndex = 0;
+    unsigned components = 0;
+
+    component.assign(count, UNVISITED);
+    for (unsigned start = 0; start != count; start++)
+    {
+        if (index[start] != UNVISITED)
+            continue;
+
+        index[start] = lowLink[start] = nextIndex++;
+        stack.push_back(start);
+        onStack[start] = 1;
+        callStack.push_back(std::make_pair(start, 0));
+
+        while (!callStack.empty())
+        {
+            unsigned node = callStack.back().first;
+            size_t& edgeIdx = callStack.back().second;
+            if (edgeIdx < edges[node].size())
+            {
+                unsigned next = edges[node][edgeIdx++];
+                if (index[next] == UNVISITED)
+                {
+                    index[next] = lowLink[next] = nextIndex++;
+                    stack.push_back(next);
+                    onStack[next] = 1;
+                    callStack.push_back(std::make_pair(next, 0));
+                }
+                else if (onStack[next])
+                {
+                    lowLink[node] = std::min(lowLink[node], index[next]);
+                }
+                continue;
+            }
+
+            callStack.pop_back();
+            if (!callStack.empty())
+            {
+                unsigned caller = callStack.back().first;
+                lowLink[caller] = std::min(lowLink[caller], lowLink[node]);
+            }
+
+            if (lowLink[node] == index[node])
+            {
+                unsigned member;
+                do
+                {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = 0;
+                    component[member] = components;
+                } while (member != node);
+                components++;
+            }
+        }
+    }
+    return components;
+}
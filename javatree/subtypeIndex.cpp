@@ -0,0 +1,223 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: subtypeIndex.cpp
+// Author: Dennis Lang
+// Desc: Constant time subtype queries over a frozen class graph.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "subtypeIndex.h"
+#include "stronglyConnected.h"
+#include <algorithm>
+
+//-------------------------------------------------------------------------------------------------
+void SubtypeIndex::build(const ClassList& clist)
+{
+    typedef std::map<const ClassRelations*, uint32_t> IdMap;
+    IdMap ids;
+    std::vector<const ClassRelations*> nodes;
+
+    my_names.clear();
+    for (ClassList::const_iterator iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        ids[iter->second] = (uint32_t)nodes.size();
+        nodes.push_back(iter->second);
+        my_names.push_back(iter->first);
+    }
+
+    // Subtypes of each class, children then implementers.
+    size_t count = nodes.size();
+    AdjacencyList subtypes(count);
+    for (size_t idx = 0; idx != count; idx++)
+    {
+        const ClassLinkage* lists[] = { &nodes[idx]->children(), &nodes[idx]->implementers() };
+        for (int list = 0; list != 2; list++)
+        {
+            for (const ClassLinkage* link_ptr = lists[list]; link_ptr != NULL; link_ptr = link_ptr->linkage)
+            {
+                IdMap::const_iterator iter = ids.find(link_ptr->relations);
+                if (link_ptr->relations != NULL && iter != ids.end())
+                {
+                    subtypes[idx].push_back(iter->second);
+                }
+            }
+        }
+    }
+
+    // Classes on an extends/implements cycle reach each other, collapse
+    // them into one node so the walk below runs over a DAG.
+    uint32_t nodeCount = StronglyConnected(subtypes, my_node);
+    AdjacencyList nodeSubs(nodeCount);
+    std::vector<char> nodeHasSuper(nodeCount, 0);
+    for (size_t idx = 0; idx != count; idx++)
+    {
+        for (size_t edge = 0; edge != subtypes[idx].size(); edge++)
+        {
+            uint32_t from = my_node[idx];
+            uint32_t to = my_node[subtypes[idx][edge]];
+            if (from != to)
+            {
+                nodeSubs[from].push_back(to);
+                nodeHasSuper[to] = 1;
+            }
+        }
+    }
+    for (uint32_t node = 0; node != nodeCount; node++)
+    {
+        std::sort(nodeSubs[node].begin(), nodeSubs[node].end());
+        nodeSubs[node].erase(std::unique(nodeSubs[node].begin(), nodeSubs[node].end()), nodeSubs[node].end());
+    }
+
+    // Iterative depth first walk from the roots, every node is reachable
+    // from one and a node is never revisited while on the stack.
+    const uint32_t UNSEEN = (uint32_t)-1;
+    my_low.assign(nodeCount, 0);
+    my_post.assign(nodeCount, UNSEEN);
+    std::vector<char> seen(nodeCount, 0);
+    std::vector<std::vector<char> > isTree(nodeCount);    // per subtype link
+    std::vector<uint32_t> postOrder;
+    std::vector<std::pair<uint32_t, size_t> > stack;
+    uint32_t nextPost = 0;
+
+    for (uint32_t start = 0; start != nodeCount; start++)
+    {
+        if (nodeHasSuper[start])
+            continue;
+
+        seen[start] = 1;
+        my_low[start] = nextPost;
+        isTree[start].assign(nodeSubs[start].size(), 0);
+        stack.push_back(std::make_pair(start, 0));
+        while (!stack.empty())
+        {
+            uint32_t node = stack.back().first;
+            size_t& edge = stack.back().second;
+            if (edge < nodeSubs[node].size())
+            {
+                uint32_t next = nodeSubs[node][edge];
+                if (!seen[next])
+                {
+                    isTree[node][edge] = 1;
+                    seen[next] = 1;
+                    my_low[next] = nextPost;
+                    isTree[next].assign(nodeSubs[next].size(), 0);
+                    stack.push_back(std::make_pair(next, 0));
+                }
+                edge++;
+                continue;
+            }
+
+            my_post[node] = nextPost++;
+            postOrder.push_back(node);
+            stack.pop_back();
+        }
+    }
+
+    // Extra intervals in post order, every subtype is finished before
+    // its supertype.
+    std::vector<std::vector<std::pair<uint32_t, uint32_t> > > extra(nodeCount);
+    for (size_t order = 0; order != postOrder.size(); order++)
+    {
+        uint32_t node = postOrder[order];
+        std::vector<std::pair<uint32_t, uint32_t> >& list = extra[node];
+        for (size_t edge = 0; edge != nodeSubs[node].size(); edge++)
+        {
+            uint32_t sub = nodeSubs[node][edge];
+            if (!isTree[node][edge])
+                list.push_back(std::make_pair(my_low[sub], my_post[sub]));
+            list.insert(list.end(), extra[sub].begin(), extra[sub].end());
+        }
+
+        // Sort, drop what the own interval covers and merge neighbours.
+        std::sort(list.begin(), list.end());
+        std::vector<std::pair<uint32_t, uint32_t> > merged;
+        for (size_t idx = 0; idx != list.size(); idx++)
+        {
+            if (list[idx].first >= my_low[node] && list[idx].second <= my_post[node])
+                continue;
+            if (!merged.empty() && list[idx].first <= merged.back().second + 1)
+                merged.back().second = std::max(merged.back().second, list[idx].second);
+            else
+                merged.push_back(list[idx]);
+        }
+        list.swap(merged);
+    }
+
+    my_extraStart.assign(1, 0);
+    my_extra.clear();
+    for (size_t idx = 0; idx != nodeCount; idx++)
+    {
+        for (size_t iIdx = 0; iIdx != extra[idx].size(); iIdx++)
+        {
+            Interval interval = { extra[idx][iIdx].first, extra[idx][iIdx].second };
+            my_extra.push_back(interval);
+        }
+        my_extraStart.push_back((uint32_t)my_extra.size());
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+unsigned SubtypeIndex::id(const lstring& name) const
+{
+    std::vector<lstring>::const_iterator iter = std::lower_bound(my_names.begin(), my_names.end(), name);
+    if (iter == my_names.end() || *iter != name)
+        return NOT_FOUND;
+    return (unsigned)(iter - my_names.begin());
+}
+
+//-------------------------------------------------------------------------------------------------
+bool SubtypeIndex::isSubtype(unsigned subId, unsigned superId) const
+{
+    if (subId >= my_node.size() || superId >= my_node.size())
+        return false;
+
+    uint32_t post = my_post[my_node[subId]];
+    superId = my_node[superId];
+    if (post >= my_low[superId] && post <= my_post[superId])
+        return true;
+
+    // Last extra interval starting at or before post.
+    const Interval* first = my_extra.data() + my_extraStart[superId];
+    const Interval* last = my_extra.data() + my_extraStart[superId + 1];
+    while (first < last)
+    {
+        const Interval* mid = first + (last - first) / 2;
+        if (mid->high < post)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    return first != my_extra.data() + my_extraStart[superId + 1] && first->low <= post;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool SubtypeIndex::isSubtype(const lstring& subName, const lstring& superName) const
+{
+    return isSubtype(id(subName), id(superName));
+}
@@ -0,0 +1,88 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: subtypeIndex.h
+// Author: Dennis Lang
+// Desc: Constant time subtype queries over a frozen class graph.
+//
+// Usage:
+//      SubtypeIndex index;
+//      index.build(clist);
+//      if (index.isSubtype("ArrayList", "List"))
+//          ...
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "class_rel.h"
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Reachability index over extends and implements links. A depth first walk
+// from the root classes numbers each class in post order, so a class and
+// its spanning tree descendants form one interval [low, post]. Links not
+// in the spanning tree (second parents, interfaces) add a short sorted
+// list of extra intervals per class. A query is one interval test, plus a
+// binary search of the extra list for classes with multiple supertypes.
+// Classes on an inheritance cycle share one node and so one interval.
+// The index is a snapshot, rebuild it after the class list changes.
+class SubtypeIndex
+{
+public:
+    static const unsigned NOT_FOUND = (unsigned)-1;
+
+    void build(const ClassList& clist);
+
+    size_t size() const
+    { return my_names.size(); }
+
+    // Class id by name, NOT_FOUND if missing.
+    unsigned id(const lstring& name) const;
+
+    const lstring& name(unsigned classId) const
+    { return my_names[classId]; }
+
+    // True if sub is super or derives from it through extends/implements.
+    bool isSubtype(unsigned subId, unsigned superId) const;
+    bool isSubtype(const lstring& subName, const lstring& superName) const;
+
+private:
+    struct Interval
+    {
+        uint32_t low;
+        uint32_t high;
+    };
+
+    std::vector<lstring>  my_names;         // sorted, index is class id
+    std::vector<unsigned> my_node;          // class id to cycle collapsed node
+    std::vector<uint32_t> my_low;           // per node, lowest post number in spanning subtree
+    std::vector<uint32_t> my_post;          // per node, post order number
+    std::vector<uint32_t> my_extraStart;    // [nodes + 1] into my_extra
+    std::vector<Interval> my_extra;         // sorted, disjoint
+};
@@ -0,0 +1,343 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: svgTree.cpp
+// Author: Dennis Lang
+// Desc: Class tree as svg, tidy tree layout without GraphViz.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "svgTree.h"
+#include <algorithm>
+#include <unordered_map>
+
+static const unsigned CHAR_WIDTH = 7;       // 11px monospace, rounded up
+static const unsigned BOX_PAD = 8;
+static const unsigned BOX_HEIGHT = 16;
+static const unsigned ROW_HEIGHT = 22;
+static const unsigned COLUMN_GAP = 32;
+static const unsigned MARGIN = 20;
+static const unsigned TITLE_HEIGHT = 30;
+
+// ---------------------------------------------------------------------------
+static void SvgText(std::ostream& out, const lstring& text)
+{
+    for (size_t idx = 0; idx != text.length(); idx++)
+    {
+        switch (text[idx])
+        {
+        case '<': out << "&lt;"; break;
+        case '>': out << "&gt;"; break;
+        case '&': out << "&amp;"; break;
+        default:  out << text[idx]; break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+static unsigned BoxWidth(const ClassRelations* crel_ptr)
+{
+    return (unsigned)crel_ptr->name().length() * CHAR_WIDTH + BOX_PAD;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Breadth first from the classes without a parent, a class is a tree
+// child of its first parent only.
+void SvgTree::build(const ClassList& clist)
+{
+    my_nodes.clear();
+    Node root = { NULL, NONE, 1, 0, 0, 0, NONE, 0, 0, 0, 0, 0, 0, 0 };
+    my_nodes.push_back(root);
+    for (ClassList::const_iterator iter = clist.begin(); iter != clist.end(); iter++)
+    {
+        if (iter->second->parents().relations == NULL)
+        {
+            Node node = { iter->second, 0, 0, 0, my_nodes[0].childCount++, 0, NONE, 0, 0, 0, 0, 0, 0, 0 };
+            my_nodes.push_back(node);
+        }
+    }
+
+    for (unsigned idx = 1; idx != my_nodes.size(); idx++)
+    {
+        const ClassRelations* crel_ptr = my_nodes[idx].crel;
+        my_nodes[idx].firstChild = (unsigned)my_nodes.size();
+        for (const ClassLinkage* link_ptr = &crel_ptr->children(); link_ptr != NULL; link_ptr = link_ptr->linkage)
+        {
+            const ClassRelations* child_ptr = link_ptr->relations;
+            if (child_ptr != NULL && child_ptr->parents().relations == crel_ptr)
+            {
+                Node node = { child_ptr, idx, 0, 0, my_nodes[idx].childCount++, my_nodes[idx].depth + 1,
+                    NONE, 0, 0, 0, 0, 0, 0, 0 };
+                my_nodes.push_back(node);
+            }
+        }
+    }
+    for (unsigned idx = 0; idx != my_nodes.size(); idx++)
+        my_nodes[idx].ancestor = idx;
+
+    layout();
+}
+
+//-------------------------------------------------------------------------------------------------
+unsigned SvgTree::nextLeft(unsigned node) const
+{
+    return (my_nodes[node].childCount != 0) ? my_nodes[node].firstChild : my_nodes[node].thread;
+}
+
+//-------------------------------------------------------------------------------------------------
+unsigned SvgTree::nextRight(unsigned node) const
+{
+    const Node& n = my_nodes[node];
+    return (n.childCount != 0) ? n.firstChild + n.childCount - 1 : n.thread;
+}
+
+//-------------------------------------------------------------------------------------------------
+void SvgTree::moveSubtree(unsigned left, unsigned right, double shift)
+{
+    double subtrees = (double)(my_nodes[right].number - my_nodes[left].number);
+    my_nodes[right].change -= shift / subtrees;
+    my_nodes[right].shift += shift;
+    my_nodes[left].change += shift / subtrees;
+    my_nodes[right].prelim += shift;
+    my_nodes[right].mod += shift;
+}
+
+//-------------------------------------------------------------------------------------------------
+void SvgTree::executeShifts(unsigned node)
+{
+    double shift = 0;
+    double change = 0;
+    const Node& n = my_nodes[node];
+    for (unsigned child = n.firstChild + n.childCount; child-- != n.firstChild; )
+    {
+        my_nodes[child].prelim += shift;
+        my_nodes[child].mod += shift;
+        change += my_nodes[child].change;
+        shift += my_nodes[child].shift + change;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Push node's subtree clear of its left siblings' subtrees, contour by
+// contour, spreading the shift over the siblings in between.
+unsigned SvgTree::apportion(unsigned node, unsigned defaultAncestor)
+{
+    if (my_nodes[node].number == 0)
+        return defaultAncestor;
+
+    unsigned vip = node;                                // inside right contour
+    unsigned vop = node;                                // outside right
+    unsigned vim = node - 1;                            // inside left
+    unsigned vom = node - my_nodes[node].number;        // outside left
+    double sip = my_nodes[vip].mod;
+    double sop = my_nodes[vop].mod;
+    double sim = my_nodes[vim].mod;
+    double som = my_nodes[vom].mod;
+
+    while (nextRight(vim) != NONE && nextLeft(vip) != NONE)
+    {
+        vim = nextRight(vim);
+        vip = nextLeft(vip);
+        vom = nextLeft(vom);
+        vop = nextRight(vop);
+        my_nodes[vop].ancestor = node;
+        double shift = (my_nodes[vim].prelim + sim) - (my_nodes[vip].prelim + sip) + 1;
+        if (shift > 0)
+        {
+            unsigned ancestor = my_nodes[vim].ancestor;
+            if (my_nodes[ancestor].parent != my_nodes[node].parent)
+                ancestor = defaultAncestor;
+            moveSubtree(ancestor, node, shift);
+            sip += shift;
+            sop += shift;
+        }
+        sim += my_nodes[vim].mod;
+        sip += my_nodes[vip].mod;
+        som += my_nodes[vom].mod;
+        sop += my_nodes[vop].mod;
+    }
+    if (nextRight(vim) != NONE && nextRight(vop) == NONE)
+    {
+        my_nodes[vop].thread = nextRight(vim);
+        my_nodes[vop].mod += sim - sop;
+    }
+    if (nextLeft(vip) != NONE && nextLeft(vom) == NONE)
+    {
+        my_nodes[vom].thread = nextLeft(vip);
+        my_nodes[vom].mod += sip - som;
+        defaultAncestor = node;
+    }
+    return defaultAncestor;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Reverse breadth first order visits children before parents, so the
+// recursive first walk becomes a loop and deep trees cannot overflow.
+void SvgTree::layout()
+{
+    for (unsigned node = (unsigned)my_nodes.size(); node-- != 0; )
+    {
+        Node& n = my_nodes[node];
+        if (n.childCount == 0)
+            continue;
+        unsigned defaultAncestor = n.firstChild;
+        for (unsigned child = n.firstChild; child != n.firstChild + n.childCount; child++)
+        {
+            Node& c = my_nodes[child];
+            if (c.number != 0)
+            {
+                c.prelim = my_nodes[child - 1].prelim + 1;
+                if (c.childCount != 0)
+                    c.mod = c.prelim - c.mid;
+            }
+            else
+                c.prelim = (c.childCount != 0) ? c.mid : 0;
+            defaultAncestor = apportion(child, defaultAncestor);
+        }
+        executeShifts(node);
+        my_nodes[node].mid = (my_nodes[n.firstChild].prelim + my_nodes[n.firstChild + n.childCount - 1].prelim) / 2;
+    }
+
+    std::vector<double> modSum(my_nodes.size(), 0);
+    double minRow = 0;
+    my_width.clear();
+    for (unsigned node = 1; node < my_nodes.size(); node++)
+    {
+        Node& n = my_nodes[node];
+        modSum[node] = modSum[n.parent] + my_nodes[n.parent].mod;
+        n.row = n.prelim + modSum[node];
+        if (node == 1 || n.row < minRow)
+            minRow = n.row;
+        if (n.depth >= my_width.size())
+            my_width.resize(n.depth + 1, 0);
+        my_width[n.depth] = std::max(my_width[n.depth], BoxWidth(n.crel));
+    }
+    for (unsigned node = 1; node < my_nodes.size(); node++)
+        my_nodes[node].row -= minRow;
+
+    my_column.resize(my_width.size());
+    for (size_t depth = 0; depth != my_width.size(); depth++)
+        my_column[depth] = (depth == 0) ? MARGIN : my_column[depth - 1] + my_width[depth - 1] + COLUMN_GAP;
+}
+
+//-------------------------------------------------------------------------------------------------
+void SvgTree::write(std::ostream& out, const lstring& title) const
+{
+    std::unordered_map<const ClassRelations*, unsigned> nodeOf;
+    double maxRow = 0;
+    for (unsigned node = 1; node < my_nodes.size(); node++)
+    {
+        nodeOf[my_nodes[node].crel] = node;
+        maxRow = std::max(maxRow, my_nodes[node].row);
+    }
+    unsigned width = my_column.empty() ? 2 * MARGIN : my_column.back() + my_width.back() + MARGIN;
+    unsigned height = TITLE_HEIGHT + (unsigned)(maxRow * ROW_HEIGHT) + BOX_HEIGHT + 2 * MARGIN;
+
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+        << "\" viewBox=\"0 0 " << width << " " << height << "\">\n"
+        "<style>\n"
+        "text { font: 11px monospace; dominant-baseline: central; }\n"
+        "rect { fill: #fff; stroke: #444; }\n"
+        "rect.r { fill: #e0ffff; } rect.a { fill: chartreuse; } rect.i { fill: #ffff80; } rect.n { stroke: red; }\n"
+        "path { fill: none; } path.t { stroke: #888; } path.p { stroke: #36c; stroke-dasharray: 4 3; } path.i { stroke: red; stroke-opacity: 0.6; }\n"
+        "</style>\n"
+        "<text x=\"" << MARGIN << "\" y=\"" << MARGIN << "\" style=\"font-size: 14px\">";
+    SvgText(out, title);
+    out << " Class Hierarchy</text>\n";
+
+    int top = MARGIN + TITLE_HEIGHT;
+
+    // Tree edges, one path: parent stub, vertical trunk, stub per child.
+    out << "<path class=\"t\" d=\"";
+    for (unsigned node = 1; node < my_nodes.size(); node++)
+    {
+        const Node& n = my_nodes[node];
+        if (n.childCount == 0)
+            continue;
+        int trunkX = (int)my_column[n.depth + 1] - (int)COLUMN_GAP / 2;
+        int firstY = top + (int)(my_nodes[n.firstChild].row * ROW_HEIGHT);
+        int lastY = top + (int)(my_nodes[n.firstChild + n.childCount - 1].row * ROW_HEIGHT);
+        out << "M" << (my_column[n.depth] + BoxWidth(n.crel)) << "," << (top + (int)(n.row * ROW_HEIGHT)) << "H" << trunkX
+            << "M" << trunkX << "," << firstY << "V" << lastY;
+        for (unsigned child = n.firstChild; child != n.firstChild + n.childCount; child++)
+            out << "M" << trunkX << "," << (top + (int)(my_nodes[child].row * ROW_HEIGHT)) << "H" << my_column[n.depth + 1];
+        out << "\n";
+    }
+    out << "\"/>\n";
+
+    for (unsigned node = 1; node < my_nodes.size(); node++)
+    {
+        const Node& n = my_nodes[node];
+        const ClassRelations* crel_ptr = n.crel;
+        int y = top + (int)(n.row * ROW_HEIGHT);
+        out << "<rect x=\"" << my_column[n.depth] << "\" y=\"" << (y - (int)BOX_HEIGHT / 2)
+            << "\" width=\"" << BoxWidth(crel_ptr) << "\" height=\"" << BOX_HEIGHT << "\"";
+
+        const char* kind = NULL;
+        if (crel_ptr->implementers().relations != NULL)
+            kind = "i";
+        else if (crel_ptr->modifier().find("abstract") != lstring::npos)
+            kind = "a";
+        else if (n.depth == 0 && n.childCount != 0)
+            kind = "r";
+        bool isPublic = (crel_ptr->modifier().find("public") != lstring::npos);
+        if (kind != NULL || !isPublic)
+        {
+            out << " class=\"";
+            if (kind != NULL)
+                out << kind << (isPublic ? "" : " ");
+            out << (isPublic ? "" : "n") << "\"";
+        }
+        out << "/><text x=\"" << (my_column[n.depth] + BOX_PAD / 2) << "\" y=\"" << y << "\">";
+        SvgText(out, crel_ptr->name());
+        out << "</text>\n";
+    }
+
+    // Links the tree does not show, second parents and interfaces, on top.
+    const char* kinds[2] = { "p", "i" };
+    for (unsigned kind = 0; kind != 2; kind++)
+    {
+        out << "<path class=\"" << kinds[kind] << "\" d=\"";
+        for (unsigned node = 1; node < my_nodes.size(); node++)
+        {
+            const Node& n = my_nodes[node];
+            const ClassLinkage* link_ptr = (kind == 0) ? n.crel->parents().linkage : &n.crel->interfaces();
+            for (; link_ptr != NULL; link_ptr = link_ptr->linkage)
+            {
+                std::unordered_map<const ClassRelations*, unsigned>::const_iterator iter;
+                if (link_ptr->relations == NULL || (iter = nodeOf.find(link_ptr->relations)) == nodeOf.end())
+                    continue;
+                const Node& from = my_nodes[iter->second];
+                out << "M" << (my_column[from.depth] + BoxWidth(from.crel)) << "," << (top + (int)(from.row * ROW_HEIGHT))
+                    << "L" << my_column[n.depth] << "," << (top + (int)(n.row * ROW_HEIGHT)) << "\n";
+            }
+        }
+        out << "\"/>\n";
+    }
+    out << "</svg>\n";
+}
@@ -0,0 +1,95 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: svgTree.h
+// Author: Dennis Lang
+// Desc: Class tree as svg, tidy tree layout without GraphViz.
+//
+// Usage:
+//      SvgTree tree;
+//      tree.build(clist);
+//      tree.write(cout, title);
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "class_rel.h"
+#include <ostream>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Left to right tree, one column per depth and one row per leaf at most.
+// Rows come from the Buchheim/Junger/Leipert linear time form of Walker's
+// tidy tree layout, so subtrees keep their shape, siblings stay evenly
+// spaced and parents sit centered on their children. Each class is placed
+// once under its first parent, links to other parents and interfaces are
+// drawn as extra edges on top of the tree. Classes only reachable through
+// an inheritance cycle are left out.
+class SvgTree
+{
+public:
+    void build(const ClassList& clist);
+    void write(std::ostream& out, const lstring& title) const;
+
+    size_t size() const
+    { return my_nodes.size(); }
+
+private:
+    static const unsigned NONE = (unsigned)-1;
+
+    struct Node
+    {
+        const ClassRelations* crel;
+        unsigned parent;
+        unsigned firstChild;        // children are contiguous
+        unsigned childCount;
+        unsigned number;            // index among siblings
+        unsigned depth;
+        unsigned thread;
+        unsigned ancestor;
+        double   prelim;
+        double   mod;
+        double   change;
+        double   shift;
+        double   mid;               // center of children
+        double   row;
+    };
+
+    unsigned nextLeft(unsigned node) const;
+    unsigned nextRight(unsigned node) const;
+    unsigned apportion(unsigned node, unsigned defaultAncestor);
+    void moveSubtree(unsigned left, unsigned right, double shift);
+    void executeShifts(unsigned node);
+    void layout();
+
+    std::vector<Node> my_nodes;         // breadth first, 0 is a virtual root
+    std::vector<unsigned> my_column;    // x of each depth
+    std::vector<unsigned> my_width;     // max box width of each depth
+};
@@ -0,0 +1,352 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: tableWriter.cpp
+// Author: Dennis Lang
+// Desc: Paged html class table, rows stream to JSON chunk files during the scan.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "tableWriter.h"
+#include "JsonString.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_WIN
+#include <direct.h>
+#define mkdir(path, mode) _mkdir(path)
+#endif
+
+static const char* const sColumnNames[TableWriter::COLUMNS] =
+    { "Package", "Type", "FullName", "Name", "Modifiers", "Filename" };
+
+static const char sPageHead[] =
+    "<!DOCTYPE html>\n"
+    "<html>\n"
+    "<head>\n"
+    "<meta charset=\"utf-8\">\n"
+    "<style>\n"
+    "body { font-family: 'Lucida Sans Unicode', 'Lucida Grande', Sans-Serif; font-size: 12px; margin: 20px; }\n"
+    "table { border-collapse: collapse; text-align: left; }\n"
+    "th { font-size: 13px; font-weight: normal; padding: 6px 8px; background: #b9c9fe; color: #039; cursor: pointer; }\n"
+    "td { padding: 4px 8px; background: #e8edff; color: #669; border-top: 1px solid #fff; white-space: nowrap; }\n"
+    "tr:hover td { background: #d0dafd; color: #339; }\n"
+    "#pager { margin: 8px 0; }\n"
+    "</style>\n";
+
+// Row i of the current view is at(i), a row number into the chunks. The
+// view is the natural or sorted order, filtered by the search text.
+static const char sPageScript[] =
+    "<script>\n"
+    "var jt = {\n"
+    "  chunks: [], sorted: [], loading: {},\n"
+    "  sortCol: -1, desc: false, filter: '', match: null, matchKey: '', page: 0, pageSize: 100,\n"
+    "  rows: function(id, rows) { this.chunks[id] = rows; this.draw(); },\n"
+    "  sort: function(col, order) { this.sorted[col] = order; this.draw(); },\n"
+    "  need: function(src) {\n"
+    "    if (this.loading[src]) return;\n"
+    "    this.loading[src] = true;\n"
+    "    var s = document.createElement('script');\n"
+    "    s.src = src;\n"
+    "    document.body.appendChild(s);\n"
+    "  },\n"
+    "  cell: function(row, col) { return this.chunks[Math.floor(row / this.chunkRows)][row % this.chunkRows][col]; },\n"
+    "  allLoaded: function() {\n"
+    "    var ok = true;\n"
+    "    for (var c = 0; c < this.chunkCount; c++)\n"
+    "      if (!this.chunks[c]) { this.need('r' + c + '.js'); ok = false; }\n"
+    "    return ok;\n"
+    "  },\n"
+    "  draw: function() {\n"
+    "    var order = null, total = this.total, self = this;\n"
+    "    if (this.sortCol >= 0) {\n"
+    "      order = this.sorted[this.sortCol];\n"
+    "      if (!order) { this.need('s' + this.sortCol + '.js'); return; }\n"
+    "    }\n"
+    "    var at = function(i) { return order ? order[self.desc ? total - 1 - i : i] : (self.desc ? total - 1 - i : i); };\n"
+    "    var count = total;\n"
+    "    if (this.filter) {\n"
+    "      if (!this.allLoaded()) return;\n"
+    "      var key = this.sortCol + ',' + this.desc + ',' + this.filter;\n"
+    "      if (this.matchKey != key) {\n"
+    "        var text = this.filter.toLowerCase();\n"
+    "        this.match = [];\n"
+    "        for (var i = 0; i < total; i++) {\n"
+    "          var row = at(i), line = this.chunks[Math.floor(row / this.chunkRows)][row % this.chunkRows];\n"
+    "          if (line.join(' ').toLowerCase().indexOf(text) >= 0) this.match.push(row);\n"
+    "        }\n"
+    "        this.matchKey = key;\n"
+    "      }\n"
+    "      count = this.match.length;\n"
+    "      at = function(i) { return self.match[i]; };\n"
+    "    }\n"
+    "    var pages = Math.max(1, Math.ceil(count / this.pageSize));\n"
+    "    this.page = Math.min(Math.max(this.page, 0), pages - 1);\n"
+    "    var first = this.page * this.pageSize, last = Math.min(first + this.pageSize, count), missing = false;\n"
+    "    for (var i = first; i < last; i++) {\n"
+    "      var c = Math.floor(at(i) / this.chunkRows);\n"
+    "      if (!this.chunks[c]) { this.need('r' + c + '.js'); missing = true; }\n"
+    "    }\n"
+    "    if (missing) return;\n"
+    "    var body = document.createElement('tbody');\n"
+    "    for (var i = first; i < last; i++) {\n"
+    "      var tr = document.createElement('tr'), row = at(i);\n"
+    "      for (var col = 0; col < this.columns; col++) {\n"
+    "        var td = document.createElement('td');\n"
+    "        td.textContent = this.cell(row, col);\n"
+    "        tr.appendChild(td);\n"
+    "      }\n"
+    "      body.appendChild(tr);\n"
+    "    }\n"
+    "    var table = document.getElementById('table');\n"
+    "    table.replaceChild(body, table.tBodies[0]);\n"
+    "    document.getElementById('info').textContent =\n"
+    "      (count ? first + 1 : 0) + '-' + last + ' of ' + count + (count != total ? ' (' + total + ' total)' : '');\n"
+    "  },\n"
+    "  go: function(delta) { this.page += delta; this.draw(); },\n"
+    "  goEnd: function() { this.page = 1e9; this.draw(); },\n"
+    "  sortBy: function(col) {\n"
+    "    this.desc = (this.sortCol == col) ? !this.desc : false;\n"
+    "    this.sortCol = col;\n"
+    "    this.page = 0;\n"
+    "    this.draw();\n"
+    "  },\n"
+    "  search: function(text) { this.filter = text; this.page = 0; this.draw(); }\n"
+    "};\n"
+    "(function() {\n"
+    "  var head = document.getElementById('table').tHead.rows[0];\n"
+    "  for (var col = 0; col < head.cells.length; col++)\n"
+    "    head.cells[col].onclick = jt.sortBy.bind(jt, col);\n"
+    "})();\n";
+
+// ---------------------------------------------------------------------------
+static void HtmlText(std::ostream& out, const lstring& text)
+{
+    for (size_t idx = 0; idx != text.length(); idx++)
+    {
+        switch (text[idx])
+        {
+        case '<': out << "&lt;"; break;
+        case '>': out << "&gt;"; break;
+        case '&': out << "&amp;"; break;
+        default:  out << text[idx]; break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Order value ids by value so the sort index can compare ranks.
+struct ValueLess
+{
+    const std::vector<const std::string*>& values;
+    ValueLess(const std::vector<const std::string*>& _values) : values(_values) {}
+    bool operator()(uint32_t id1, uint32_t id2) const
+    { return *values[id1] < *values[id2]; }
+};
+
+//-------------------------------------------------------------------------------------------------
+TableWriter::TableWriter(size_t chunkRows) :
+    my_chunkRows(chunkRows),
+    my_rows(0),
+    my_failed(false)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+bool TableWriter::open(const lstring& outDir)
+{
+    if (mkdir(outDir.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        std::cerr << "Classtree: Unable to create " << outDir << " " << strerror(errno) << std::endl;
+        return false;
+    }
+    my_dirPath = outDir;
+    if (my_dirPath[my_dirPath.length() - 1] != '/')
+        my_dirPath += "/";
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void TableWriter::addCell(unsigned column, const lstring& value)
+{
+    ValueIds::const_iterator iter = my_ids[column].find(value);
+    if (iter == my_ids[column].end())
+    {
+        iter = my_ids[column].insert(std::make_pair(value, (uint32_t)my_values[column].size())).first;
+        my_values[column].push_back(&iter->first);
+    }
+    my_cells.push_back(iter->second);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TableWriter::add(const TableItem& item)
+{
+    if (!isOpen())
+        return;
+
+    if (my_rows % my_chunkRows == 0)
+    {
+        std::ostringstream chunkPath;
+        chunkPath << my_dirPath << 'r' << (my_rows / my_chunkRows) << ".js";
+        my_chunk.open(chunkPath.str().c_str());
+        if (!my_chunk.good())
+        {
+            std::cerr << "Classtree: Unable to write " << chunkPath.str() << std::endl;
+            my_failed = true;
+        }
+        my_chunk << "jt.rows(" << (my_rows / my_chunkRows) << ",[\n";
+    }
+    else
+        my_chunk << ",\n";
+
+    const lstring* cells[COLUMNS] =
+        { &item.package, &item.type, &item.fullClassName, &item.className, &item.modifier, &item.filename };
+    my_chunk << '[';
+    for (unsigned col = 0; col != COLUMNS; col++)
+    {
+        if (col != 0)
+            my_chunk << ',';
+        JsonString(my_chunk, cells[col]->c_str());
+        addCell(col, *cells[col]);
+    }
+    my_chunk << ']';
+
+    if (++my_rows % my_chunkRows == 0)
+        endChunk();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool TableWriter::endChunk()
+{
+    my_chunk << "]);\n";
+    my_chunk.close();
+    if (my_chunk.fail())
+        my_failed = true;
+    my_chunk.clear();
+    return !my_failed;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Rank the column's distinct values, then counting sort the rows by rank,
+// rows with equal values keep scan order.
+bool TableWriter::writeSortIndex(unsigned column)
+{
+    const std::vector<const std::string*>& values = my_values[column];
+    std::vector<uint32_t> byValue(values.size());
+    for (uint32_t id = 0; id != byValue.size(); id++)
+        byValue[id] = id;
+    std::sort(byValue.begin(), byValue.end(), ValueLess(values));
+
+    std::vector<uint32_t> counts(values.size(), 0);
+    for (size_t row = 0; row != my_rows; row++)
+        counts[my_cells[row * COLUMNS + column]]++;
+    std::vector<uint32_t> runStart(values.size());
+    uint32_t slot = 0;
+    for (size_t rank = 0; rank != byValue.size(); rank++)
+    {
+        runStart[byValue[rank]] = slot;
+        slot += counts[byValue[rank]];
+    }
+    std::vector<uint32_t> order(my_rows);
+    for (size_t row = 0; row != my_rows; row++)
+        order[runStart[my_cells[row * COLUMNS + column]]++] = (uint32_t)row;
+
+    std::ostringstream sortPath;
+    sortPath << my_dirPath << 's' << column << ".js";
+    std::ofstream out(sortPath.str().c_str());
+    out << "jt.sort(" << column << ",[";
+    for (size_t idx = 0; idx != order.size(); idx++)
+    {
+        if (idx != 0)
+            out << ((idx % 20 == 0) ? ",\n" : ",");
+        out << order[idx];
+    }
+    out << "]);\n";
+    out.close();
+    if (out.fail())
+    {
+        std::cerr << "Classtree: Unable to write " << sortPath.str() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool TableWriter::close(const lstring& title)
+{
+    if (!isOpen())
+        return false;
+    if (my_rows % my_chunkRows != 0)
+        endChunk();
+    if (my_failed)
+        return false;
+
+    for (unsigned col = 0; col != COLUMNS; col++)
+    {
+        if (!writeSortIndex(col))
+            return false;
+    }
+
+    lstring indexPath = my_dirPath + "index.html";
+    std::ofstream index(indexPath.c_str());
+    index << sPageHead << "<title>";
+    HtmlText(index, title);
+    index << "</title>\n</head>\n<body>\n<h2>Tabular List of ";
+    HtmlText(index, title);
+    index << "</h2>\n"
+        "<div id=\"pager\">\n"
+        "<button onclick=\"jt.go(-1e9)\">&lt;&lt;</button>\n"
+        "<button onclick=\"jt.go(-1)\">&lt;</button>\n"
+        "<span id=\"info\"></span>\n"
+        "<button onclick=\"jt.go(1)\">&gt;</button>\n"
+        "<button onclick=\"jt.goEnd()\">&gt;&gt;</button>\n"
+        "Search <input oninput=\"jt.search(this.value)\">\n"
+        "</div>\n"
+        "<table id=\"table\">\n<thead>\n<tr>";
+    for (unsigned col = 0; col != COLUMNS; col++)
+        index << "<th>" << sColumnNames[col] << "</th>";
+    index << "</tr>\n</thead>\n<tbody></tbody>\n</table>\n"
+        << sPageScript
+        << "jt.columns = " << COLUMNS << ";\n"
+        << "jt.total = " << my_rows << ";\n"
+        << "jt.chunkRows = " << my_chunkRows << ";\n"
+        << "jt.chunkCount = " << (my_rows + my_chunkRows - 1) / my_chunkRows << ";\n"
+        << "jt.draw();\n"
+        << "</script>\n</body>\n</html>\n";
+    index.close();
+    if (index.fail())
+    {
+        std::cerr << "Classtree: Unable to write " << indexPath << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,103 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: tableWriter.h
+// Author: Dennis Lang
+// Desc: Paged html class table, rows stream to JSON chunk files during the scan.
+//
+// Usage:
+//      TableWriter table;
+//      table.open("classTable");      // before scan
+//      table.add(item);                // per class, rows stream to disk
+//      table.close(title);             // sort index and classTable/index.html
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TableItem
+{
+    lstring package;
+    lstring type;   // class or interface
+    lstring className;
+    lstring fullClassName;
+    lstring modifier;
+    lstring filename;
+};
+typedef std::vector<TableItem> TableList;
+
+// ---------------------------------------------------------------------------
+// -T output for class lists too big for one html table. Rows are appended
+// to r<N>.js chunk files as they are found, only a string id per cell is
+// kept. close() ranks each column's distinct values and writes s<col>.js,
+// the row order sorted by that column, then index.html. The page shows one
+// page of rows at a time and loads only the chunks that page needs, a sort
+// index when its column is clicked, and all chunks for a search.
+class TableWriter
+{
+public:
+    static const unsigned COLUMNS = 6;
+
+    TableWriter(size_t chunkRows = 5000);
+
+    bool open(const lstring& outDir);
+    bool isOpen() const
+    { return !my_dirPath.empty(); }
+
+    void add(const TableItem& item);
+
+    // Finish last chunk, write sort indices and index.html.
+    bool close(const lstring& title);
+
+    size_t size() const
+    { return my_rows; }
+
+private:
+    typedef std::unordered_map<std::string, uint32_t> ValueIds;
+
+    void addCell(unsigned column, const lstring& value);
+    bool endChunk();
+    bool writeSortIndex(unsigned column);
+
+    size_t      my_chunkRows;
+    lstring     my_dirPath;
+    std::ofstream my_chunk;
+    size_t      my_rows;
+    bool        my_failed;
+
+    ValueIds    my_ids[COLUMNS];                // distinct values per column
+    std::vector<const std::string*> my_values[COLUMNS];  // by id
+    std::vector<uint32_t> my_cells;             // [rows * COLUMNS] value ids
+};
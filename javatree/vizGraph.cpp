@@ -0,0 +1,211 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: vizGraph.cpp
+// Author: Dennis Lang
+// Desc: Collect one GraphViz file of the class tree, declare each node once.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "vizGraph.h"
+#include "packageGraph.h"
+#include <map>
+
+// ---------------------------------------------------------------------------
+// GraphViz id, dots become line breaks in the label.
+static void OutVizName(std::ostream& out, const lstring& name)
+{
+    out << '"';
+    for (size_t idx = 0; idx != name.length(); idx++)
+    {
+        if (name[idx] == '.')
+            out << "\\n";
+        else
+            out << name[idx];
+    }
+    out << '"';
+}
+
+//-------------------------------------------------------------------------------------------------
+VizGraph::Node& VizGraph::node(const ClassRelations* crel_ptr)
+{
+    std::pair<std::unordered_map<const ClassRelations*, size_t>::iterator, bool> found =
+        my_nodeIdx.insert(std::make_pair(crel_ptr, my_nodes.size()));
+    if (found.second)
+    {
+        Node node = { crel_ptr, false };
+        my_nodes.push_back(node);
+    }
+    return my_nodes[found.first->second];
+}
+
+//-------------------------------------------------------------------------------------------------
+void VizGraph::addNode(const ClassRelations* crel_ptr)
+{
+    node(crel_ptr);
+}
+
+//-------------------------------------------------------------------------------------------------
+void VizGraph::addInterface(const ClassRelations* crel_ptr)
+{
+    node(crel_ptr).isInterface = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void VizGraph::addEdge(const ClassRelations* from_ptr, const ClassRelations* to_ptr, Edge kind)
+{
+    node(from_ptr);
+    node(to_ptr);
+    EdgeKey key = { from_ptr, to_ptr, kind };
+    if (my_edgeSet.insert(key).second)
+        my_edges.push_back(key);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Class with subclasses is cyan, light cyan at the top of the tree, an
+// abstract one chartreuse (green outline at the top). Other abstract
+// classes are chartreuse, interfaces yellow, non public classes outlined
+// red.
+void VizGraph::writeNode(std::ostream& out, const Node& node) const
+{
+    const ClassRelations* crel_ptr = node.crel;
+    bool isRoot = (crel_ptr->parents().relations == NULL);
+    bool hasChildren = (crel_ptr->children().relations != NULL);
+    bool isAbstract = (crel_ptr->modifier().find("abstract") != lstring::npos);
+    bool isPublic = (crel_ptr->modifier().find("public") != lstring::npos);
+
+    const char* fill = NULL;
+    const char* color = NULL;
+    if (hasChildren)
+    {
+        if (!isAbstract)
+            fill = isRoot ? "cyan1" : "cyan4";
+        else if (isRoot)
+            color = "green";
+        else
+            fill = "chartreuse";
+    }
+    else if (isAbstract)
+        fill = "chartreuse";
+    else if (node.isInterface)
+        fill = "yellow";
+    if (!isPublic && !(isRoot && hasChildren))
+        color = "red";
+
+    OutVizName(out, crel_ptr->name());
+    if (fill != NULL && color != NULL)
+        out << " [fillcolor=" << fill << ",color=" << color << "]";
+    else if (fill != NULL)
+        out << " [fillcolor=" << fill << "]";
+    else if (color != NULL)
+        out << " [color=" << color << "]";
+    out << "\n";
+}
+
+//-------------------------------------------------------------------------------------------------
+void VizGraph::write(std::ostream& out) const
+{
+    if (my_nodes.empty())
+        return;
+
+    bool sfdp = my_nodes.size() > SFDP_NODES;
+    if (sfdp)
+        out << "layout=sfdp;\nsplines=false;\n";
+    else if (my_nodes.size() > FAST_DOT_NODES)
+        out << "mclimit=0.3;\nnslimit=2;\nnslimit1=2;\n";
+
+    typedef std::map<lstring, std::vector<size_t> > PackageNodes;
+    PackageNodes packages;
+    std::vector<size_t> roots;
+    for (size_t idx = 0; idx != my_nodes.size(); idx++)
+    {
+        const ClassRelations* crel_ptr = my_nodes[idx].crel;
+        // sfdp ignores clusters and ranks, save the bytes.
+        packages[sfdp ? lstring() : PackageOf(crel_ptr->name())].push_back(idx);
+        if (crel_ptr->parents().relations == NULL && crel_ptr->children().relations != NULL)
+            roots.push_back(idx);
+    }
+
+    if (!sfdp && packages.size() > 1)
+        out << "newrank=true;\n";
+    for (PackageNodes::const_iterator iter = packages.begin(); iter != packages.end(); iter++)
+    {
+        const std::vector<size_t>& nodes = iter->second;
+        if (!iter->first.empty())
+            out << "subgraph \"cluster_" << iter->first << "\" {\nlabel=\"" << iter->first << "\";\n";
+        for (size_t idx = 0; idx != nodes.size(); idx++)
+            writeNode(out, my_nodes[nodes[idx]]);
+        if (!iter->first.empty())
+            out << "}\n";
+    }
+
+    // Base classes on the top row.
+    if (!sfdp && roots.size() > 1)
+    {
+        out << "{ rank=min;";
+        for (size_t idx = 0; idx != roots.size(); idx++)
+        {
+            out << ' ';
+            OutVizName(out, my_nodes[roots[idx]].crel->name());
+        }
+        out << " }\n";
+    }
+
+    for (size_t idx = 0; idx != my_edges.size(); idx++)
+    {
+        const EdgeKey& edge = my_edges[idx];
+        OutVizName(out, edge.from->name());
+        out << " -> ";
+        OutVizName(out, edge.to->name());
+
+        EdgeWeights::const_iterator weight;
+        if (my_weights != NULL && (weight = my_weights->find(edge)) != my_weights->end())
+        {
+            // Pen width grows with log2 of the relation count.
+            unsigned width = 1;
+            for (unsigned count = weight->second; count > 1; count >>= 1)
+                width++;
+            out << " [label=" << weight->second << ",weight=" << weight->second << ",penwidth=" << width;
+            if (edge.kind == IMPLEMENTS)
+                out << ",color=red";
+            out << "]";
+        }
+        else if (edge.kind == IMPLEMENTS)
+            out << " [color=red,penwidth=3.0]";
+        out << "\n";
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void VizGraph::clear()
+{
+    my_nodes.clear();
+    my_nodeIdx.clear();
+    my_edges.clear();
+    my_edgeSet.clear();
+}
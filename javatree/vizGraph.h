@@ -0,0 +1,115 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: vizGraph.h
+// Author: Dennis Lang
+// Desc: Collect one GraphViz file of the class tree, declare each node once.
+//
+// Usage:
+//      VizGraph graph;
+//      graph.addNode(crel_ptr);
+//      graph.addEdge(parent_ptr, crel_ptr, VizGraph::EXTENDS);
+//      graph.write(cout);      // between outVizHeader and outVizTrailer
+//      graph.clear();
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include "class_rel.h"
+#include <map>
+#include <ostream>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Nodes and edges of one -z output file. A class reached through several
+// parents or implementing several interfaces is still declared once with
+// its final attributes, and repeated edges are dropped. Package qualified
+// classes (--resolve) are grouped in one cluster per package. Graph
+// attributes pick the layout engine by node count. Edges found in the
+// optional weights (package view) are labeled and thickened by weight.
+class VizGraph
+{
+public:
+    enum Edge { EXTENDS, IMPLEMENTS };
+
+    struct EdgeKey
+    {
+        const ClassRelations* from;
+        const ClassRelations* to;
+        Edge    kind;
+
+        bool operator<(const EdgeKey& other) const
+        {
+            if (from != other.from)
+                return from < other.from;
+            if (to != other.to)
+                return to < other.to;
+            return kind < other.kind;
+        }
+    };
+    typedef std::map<EdgeKey, unsigned> EdgeWeights;
+
+    VizGraph() : my_weights(NULL) {}
+
+    // Above these node counts dot is tuned for speed, then sfdp is used.
+    static const size_t FAST_DOT_NODES = 800;
+    static const size_t SFDP_NODES = 4000;
+
+    void addNode(const ClassRelations* crel_ptr);
+    void addInterface(const ClassRelations* crel_ptr);
+    void addEdge(const ClassRelations* from_ptr, const ClassRelations* to_ptr, Edge kind);
+
+    size_t size() const
+    { return my_nodes.size(); }
+
+    void weights(const EdgeWeights* weights)
+    { my_weights = weights; }
+
+    void write(std::ostream& out) const;
+    void clear();
+
+private:
+    struct Node
+    {
+        const ClassRelations* crel;
+        bool    isInterface;
+    };
+    Node& node(const ClassRelations* crel_ptr);
+    void writeNode(std::ostream& out, const Node& node) const;
+
+    std::vector<Node> my_nodes;                         // first seen order
+    std::unordered_map<const ClassRelations*, size_t> my_nodeIdx;
+    std::vector<EdgeKey> my_edges;
+    std::set<EdgeKey> my_edgeSet;
+    const EdgeWeights* my_weights;
+};
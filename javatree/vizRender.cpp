@@ -0,0 +1,250 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: vizRender.cpp
+// Author: Dennis Lang
+// Desc: Render GraphViz files with the dot program on a pool of processes.
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "vizRender.h"
+#include "MappedFile.h"
+#include "fnvHash.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifndef HAVE_WIN
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+// ---------------------------------------------------------------------------
+static bool FileExists(const lstring& path)
+{
+    struct stat info;
+    return stat(path, &info) == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+VizRender::VizRender(const lstring& format, size_t jobs, const lstring& cachePath) :
+    my_format(format),
+    my_jobs(jobs != 0 ? jobs : 1),
+    my_cachePath(cachePath),
+    my_rendered(0),
+    my_skipped(0)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+void VizRender::add(const lstring& gvPath)
+{
+    my_paths.push_back(gvPath);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool VizRender::largestFirst(const Job& lhs, const Job& rhs)
+{
+    if (lhs.size != rhs.size)
+        return lhs.size > rhs.size;
+    return strcmp(lhs.gvPath, rhs.gvPath) < 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool VizRender::hashFile(const lstring& path, uint64_t& hash, size_t& size)
+{
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+
+    size = file.length();
+    hash = FnvHash(file.data(), size);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Cache line: <hash hex> <format> <gv path>
+void VizRender::readCache()
+{
+    my_cache.clear();
+    std::ifstream in(my_cachePath);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string hashStr, format, path;
+        if (!(fields >> hashStr >> format) || !std::getline(fields >> std::ws, path))
+            continue;
+        CacheEntry& entry = my_cache[path.c_str()];
+        entry.hash = strtoull(hashStr.c_str(), NULL, 16);
+        entry.format = format.c_str();
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+bool VizRender::writeCache() const
+{
+    std::ofstream out(my_cachePath);
+    if (!out.good())
+        return false;
+    char hashStr[20];
+    for (RenderCache::const_iterator iter = my_cache.begin(); iter != my_cache.end(); iter++)
+    {
+        snprintf(hashStr, sizeof(hashStr), "%016llx", (unsigned long long)iter->second.hash);
+        out << hashStr << " " << iter->second.format << " " << iter->first << "\n";
+    }
+    return out.good();
+}
+
+#ifdef HAVE_WIN
+
+bool VizRender::start(const Job& job, int& pid) const
+{
+    return false;
+}
+
+bool VizRender::run()
+{
+    std::cerr << "Classtree: --render not supported on this platform\n";
+    return false;
+}
+
+#else
+
+//-------------------------------------------------------------------------------------------------
+bool VizRender::start(const Job& job, int& pid) const
+{
+    lstring typeArg = "-T";
+    typeArg += my_format;
+    pid = fork();
+    if (pid == 0)
+    {
+        execlp("dot", "dot", typeArg.c_str(), job.gvPath.c_str(), "-o", job.outPath.c_str(), (char*)NULL);
+        _exit(127);
+    }
+    return pid > 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool VizRender::run()
+{
+    readCache();
+    my_rendered = my_skipped = 0;
+
+    std::vector<Job> jobs;
+    for (size_t idx = 0; idx != my_paths.size(); idx++)
+    {
+        Job job;
+        job.gvPath = my_paths[idx];
+        job.outPath = job.gvPath;
+        size_t dotPos = job.outPath.rfind('.');
+        if (dotPos != std::string::npos && job.outPath.substr(dotPos) == ".gv")
+            job.outPath.resize(dotPos);
+        job.outPath += ".";
+        job.outPath += my_format;
+
+        if (!hashFile(job.gvPath, job.hash, job.size))
+        {
+            std::cerr << "Classtree: Failed to read " << job.gvPath << std::endl;
+            continue;
+        }
+
+        RenderCache::const_iterator cached = my_cache.find(job.gvPath);
+        if (cached != my_cache.end() && cached->second.hash == job.hash
+            && cached->second.format == my_format && FileExists(job.outPath))
+            my_skipped++;
+        else
+            jobs.push_back(job);
+    }
+    std::sort(jobs.begin(), jobs.end(), largestFirst);
+
+    // Keep my_jobs dot processes busy, next largest file starts as one exits.
+    std::map<int, size_t> running;  // pid to job index
+    size_t next = 0;
+    bool okay = true;
+    bool noDot = false;
+    while (next != jobs.size() || !running.empty())
+    {
+        while (next != jobs.size() && running.size() < my_jobs)
+        {
+            int pid;
+            if (start(jobs[next], pid))
+                running[pid] = next;
+            else
+            {
+                std::cerr << "Classtree: Failed to run dot on " << jobs[next].gvPath << std::endl;
+                okay = false;
+            }
+            next++;
+        }
+        if (running.empty())
+            continue;
+
+        int status;
+        int pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+            break;
+        std::map<int, size_t>::iterator iter = running.find(pid);
+        if (iter == running.end())
+            continue;
+        const Job& job = jobs[iter->second];
+        running.erase(iter);
+
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        {
+            CacheEntry& entry = my_cache[job.gvPath];
+            entry.hash = job.hash;
+            entry.format = my_format;
+            my_rendered++;
+        }
+        else
+        {
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 127)
+            {
+                if (!noDot)
+                    std::cerr << "Classtree: dot not found, install GraphViz\n";
+                noDot = true;
+            }
+            else
+                std::cerr << "Classtree: dot failed on " << job.gvPath << std::endl;
+            my_cache.erase(job.gvPath);
+            okay = false;
+        }
+    }
+
+    if (!writeCache())
+        std::cerr << "Classtree: Failed to write " << my_cachePath << std::endl;
+    return okay;
+}
+
+#endif
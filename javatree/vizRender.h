@@ -0,0 +1,96 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: vizRender.h
+// Author: Dennis Lang
+// Desc: Render GraphViz files with the dot program on a pool of processes.
+//
+// Usage:
+//      VizRender render("svg", 8, "viz/.render-cache");
+//      render.add("viz/Base.gv");
+//      render.run();       // viz/Base.svg, unchanged files are skipped
+//
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2015
+// http://landenlabs.com
+//
+// This file is part of JavaTree project.
+//
+// ----- License ----
+//
+// Copyright (c) 2015 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+#include "ll_stdhdr.h"
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Runs "dot -T<format> x.gv -o x.<format>" for each added file, at most
+// jobs at once and largest file first so the slowest layouts do not end
+// up last on one process. The cache file remembers a hash of each .gv
+// file that rendered, a file with the same hash, format and an existing
+// output is skipped on the next run.
+class VizRender
+{
+public:
+    VizRender(const lstring& format, size_t jobs, const lstring& cachePath);
+
+    void add(const lstring& gvPath);
+
+    // Render changed files, false if dot failed on any.
+    bool run();
+
+    size_t rendered() const
+    { return my_rendered; }
+    size_t skipped() const
+    { return my_skipped; }
+
+private:
+    struct Job
+    {
+        lstring  gvPath;
+        lstring  outPath;
+        uint64_t hash;
+        size_t   size;
+    };
+    struct CacheEntry
+    {
+        uint64_t hash;
+        lstring  format;
+    };
+    typedef std::map<lstring, CacheEntry> RenderCache;      // by gv path
+
+    static bool largestFirst(const Job& lhs, const Job& rhs);
+    static bool hashFile(const lstring& path, uint64_t& hash, size_t& size);
+    void readCache();
+    bool writeCache() const;
+    bool start(const Job& job, int& pid) const;
+
+    lstring     my_format;
+    size_t      my_jobs;
+    lstring     my_cachePath;
+    std::vector<lstring> my_paths;
+    RenderCache my_cache;
+    size_t      my_rendered;
+    size_t      my_skipped;
+};